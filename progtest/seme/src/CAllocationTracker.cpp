@@ -0,0 +1,204 @@
+#include "CAllocationTracker.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include <execinfo.h>
+#include <unistd.h>
+
+/** \class CAllocationSite
+The allocations of a frame made from one call site.
+*/
+struct CAllocationSite
+{
+    void *site;   ///< return address of the allocating call
+    size_t count; ///< number of allocations made from it
+};
+
+thread_local bool counting = false;                                     // true between beginFrame and endFrame
+thread_local size_t allocations = 0;                                    // allocations of the current frame
+thread_local size_t siteCount = 0;                                      // call sites in sites
+thread_local CAllocationSite sites[CAllocationTracker::MAX_SITES] = {}; // call sites of the current frame
+
+bool CAllocationTracker::isEnabled()
+{
+#ifdef TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CAllocationTracker::beginFrame()
+{
+    allocations = 0;
+    siteCount = 0;
+    counting = true;
+}
+
+size_t CAllocationTracker::endFrame()
+{
+    counting = false;
+    return allocations;
+}
+
+void CAllocationTracker::report()
+{
+    for (size_t i = 0; i < siteCount; i++)
+    {
+        // backtrace_symbols_fd writes straight to the descriptor, it does not allocate
+        printf("%zu allocations from ", sites[i].count);
+        fflush(stdout);
+        backtrace_symbols_fd(&sites[i].site, 1, STDOUT_FILENO);
+    }
+}
+
+void CAllocationTracker::record(void *site)
+{
+    if (!counting)
+        return;
+
+    allocations++;
+
+    for (size_t i = 0; i < siteCount; i++)
+        if (sites[i].site == site)
+        {
+            sites[i].count++;
+            return;
+        }
+
+    if (siteCount < MAX_SITES)
+        sites[siteCount++] = {site, 1};
+}
+
+#ifdef TRACK_ALLOCATIONS
+
+// glibc's own allocator, the replaced functions forward to it
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *pointer, size_t size);
+extern "C" void *__libc_memalign(size_t alignment, size_t size);
+
+extern "C" void *malloc(size_t size)
+{
+    CAllocationTracker::record(__builtin_return_address(0));
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    CAllocationTracker::record(__builtin_return_address(0));
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *pointer, size_t size)
+{
+    CAllocationTracker::record(__builtin_return_address(0));
+    return __libc_realloc(pointer, size);
+}
+
+void *operator new(size_t size)
+{
+    CAllocationTracker::record(__builtin_return_address(0));
+
+    void *pointer = __libc_malloc(size ? size : 1);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new[](size_t size)
+{
+    CAllocationTracker::record(__builtin_return_address(0));
+
+    void *pointer = __libc_malloc(size ? size : 1);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+// the aligned versions are used for types aligned more strictly than malloc aligns, e.g. alignas(64)
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    CAllocationTracker::record(__builtin_return_address(0));
+
+    void *pointer = __libc_memalign(static_cast<size_t>(alignment), size ? size : 1);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new[](size_t size, std::align_val_t alignment)
+{
+    CAllocationTracker::record(__builtin_return_address(0));
+
+    void *pointer = __libc_memalign(static_cast<size_t>(alignment), size ? size : 1);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    CAllocationTracker::record(__builtin_return_address(0));
+    return __libc_memalign(static_cast<size_t>(alignment), size ? size : 1);
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    CAllocationTracker::record(__builtin_return_address(0));
+    return __libc_memalign(static_cast<size_t>(alignment), size ? size : 1);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer, size_t, std::align_val_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    free(pointer);
+}
+
+#endif
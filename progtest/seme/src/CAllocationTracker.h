@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+/** \class CAllocationTracker
+Counts the heap allocations of a frame, grouped by the code that made them. Used to check that a steady-state frame does not allocate.
+
+Allocations are only seen in a build with TRACK_ALLOCATIONS defined (make allocdebug), which replaces the global operator new (the aligned versions too) and malloc.
+Otherwise every frame counts as free of allocations. Only the thread that began the frame is counted, and the tracker itself never allocates.
+*/
+class CAllocationTracker
+{
+public:
+    static constexpr size_t MAX_SITES = 64; ///< distinct call sites kept per frame, allocations from further ones are counted but not listed
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Checks if the program was built with TRACK_ALLOCATIONS.
+    static bool isEnabled();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Starts counting the allocations of the calling thread, the counts of the previous frame are dropped.
+    static void beginFrame();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Stops counting.
+    ///
+    /// @return number of allocations since beginFrame
+    static size_t endFrame();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Prints every call site that allocated in the last frame with the number of its allocations. The sites are printed as return addresses,
+    /// they are resolved with addr2line -e binary address, the debug build keeps the symbols for it.
+    static void report();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Counts an allocation. Called by the replaced allocation functions.
+    ///
+    /// @param [in] site the return address of the allocating call
+    static void record(void *site);
+};
@@ -0,0 +1,97 @@
+#include "CBoardLayer.h"
+
+CBoardLayer::~CBoardLayer()
+{
+    destroy();
+}
+
+void CBoardLayer::destroy()
+{
+    if (texture != nullptr)
+        SDL_DestroyTexture(texture);
+
+    texture = nullptr;
+    valid = false;
+}
+
+void CBoardLayer::invalidate()
+{
+    valid = false;
+}
+
+void CBoardLayer::drawBoard(const CGameState &gamestate, const CCollectibleGrid &collectibles)
+{
+    const CGameMap &gameMap = gamestate.gameMap;
+    int left, top, right, bottom;
+    camera.getVisibleTiles(left, top, right, bottom);
+
+    for (int i = top; i < bottom; i++)
+        for (int j = left; j < right; j++)
+            if (gameMap.getTile(j, i) == gameMap.CMapObjects::W)
+                canvas.fillTile(CPos(j, i), 1, 20, 20, 50);
+
+    collectibles.draw(canvas, left, top, right, bottom);
+    batch.flush();
+}
+
+void CBoardLayer::build(const CGameState &gamestate, const CCollectibleGrid &collectibles)
+{
+    if (texture == nullptr)
+    {
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, gamestate.WINDOW_WIDTH, gamestate.WINDOW_HEIGHT);
+        if (texture == nullptr || SDL_SetRenderTarget(renderer, texture) != 0)
+        {
+            unsupported = true;
+            return;
+        }
+    }
+    else
+        SDL_SetRenderTarget(renderer, texture);
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    drawBoard(gamestate, collectibles);
+    SDL_SetRenderTarget(renderer, nullptr);
+
+    valid = true;
+    generation = collectibles.getGeneration();
+    erased = collectibles.getPickups().size();
+}
+
+void CBoardLayer::erasePickups(const CCollectibleGrid &collectibles)
+{
+    const std::vector<std::pair<int, int>> &pickups = collectibles.getPickups();
+    if (erased == pickups.size())
+        return;
+
+    // pellets are drawn inside of walkable tiles, so clearing the whole tile erases exactly the pellet
+    for (; erased < pickups.size(); erased++)
+        batch.add(canvas.getTileRect(pickups[erased].first, pickups[erased].second), 0, 0, 0);
+
+    SDL_SetRenderTarget(renderer, texture);
+    batch.flush();
+    SDL_SetRenderTarget(renderer, nullptr);
+}
+
+void CBoardLayer::draw(const CGameState &gamestate, const CCollectibleGrid &collectibles)
+{
+    if (!camera.showsWholeBoard())
+    {
+        drawBoard(gamestate, collectibles);
+        return;
+    }
+
+    if (!unsupported && (!valid || generation != collectibles.getGeneration()))
+        build(gamestate, collectibles);
+
+    if (unsupported)
+    {
+        drawBoard(gamestate, collectibles);
+        return;
+    }
+
+    erasePickups(collectibles);
+
+    SDL_Rect board = {0, 0, gamestate.WINDOW_WIDTH, gamestate.WINDOW_HEIGHT};
+    SDL_RenderCopy(renderer, texture, nullptr, &board);
+}
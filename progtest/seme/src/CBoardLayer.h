@@ -0,0 +1,81 @@
+#pragma once
+
+#include "CGameState.h"
+#include "CCollectibleGrid.h"
+#include "CSDLCanvas.h"
+#include "CCamera.h"
+#include "CSpriteBatch.h"
+
+#include <SDL2/SDL.h>
+
+/** \class CBoardLayer
+The static part of the board (walls and pellets), pre-rendered into a target texture when a level is loaded.
+
+Every frame, the pellets collected since the previous frame are erased from the texture and the texture is copied to the screen with a single blit.
+If the renderer does not support target textures, or the board does not fit into the window and the camera scrolls over it,
+the board is drawn directly every frame instead. Only the tiles the camera sees are visited then, so the cost does not grow with the size of the board.
+*/
+class CBoardLayer
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Constructor that binds the layer to a renderer
+    ///
+    /// @param [in] renderer pointer to the SDL_Renderer
+    /// @param [in] canvas the canvas the board is drawn on
+    /// @param [in] batch the sprite batch behind the canvas
+    /// @param [in] camera the camera that decides which part of the board is shown
+    CBoardLayer(SDL_Renderer *renderer, CSDLCanvas &canvas, CSpriteBatch &batch, const CCamera &camera) : renderer(renderer), canvas(canvas), batch(batch), camera(camera){};
+    CBoardLayer(const CBoardLayer &) = delete;
+    CBoardLayer &operator=(const CBoardLayer &) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Destroys the texture
+    ~CBoardLayer();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Destroys the texture. Has to be called before the renderer is destroyed.
+    void destroy();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Draws the board. Re-renders the texture if a new level was loaded and erases the pellets collected since the previous frame.
+    ///
+    /// @param [in] gamestate a gamestate instance, only its map and the window size are read
+    /// @param [in] collectibles the collectibles
+    void draw(const CGameState &gamestate, const CCollectibleGrid &collectibles);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Forces the texture to be re-rendered on the next draw. Called when SDL reports that the contents of target textures were lost.
+    void invalidate();
+
+private:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Renders the walls and the remaining pellets into the texture, creating it if needed.
+    ///
+    /// @param [in] gamestate a gamestate instance, only its map and the window size are read
+    /// @param [in] collectibles the collectibles
+    void build(const CGameState &gamestate, const CCollectibleGrid &collectibles);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Erases the pellets collected since the last call from the texture.
+    ///
+    /// @param [in] collectibles the collectibles
+    void erasePickups(const CCollectibleGrid &collectibles);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Draws the walls and the remaining pellets the camera sees to the current render target, in a single batch.
+    ///
+    /// @param [in] gamestate a gamestate instance, only its map and the window size are read
+    /// @param [in] collectibles the collectibles
+    void drawBoard(const CGameState &gamestate, const CCollectibleGrid &collectibles);
+
+    SDL_Renderer *renderer;         ///< the renderer that is drawn with
+    CSDLCanvas &canvas;             ///< the canvas the board is drawn on
+    CSpriteBatch &batch;            ///< the sprite batch behind the canvas
+    const CCamera &camera;          ///< the camera that decides which part of the board is shown
+    SDL_Texture *texture = nullptr; ///< the pre-rendered board
+    bool unsupported = false;       ///< true if target textures could not be created, the board is then drawn directly
+    bool valid = false;             ///< false if the texture has to be re-rendered
+    unsigned int generation = 0;    ///< generation of the collectible grid the texture was rendered for
+    size_t erased = 0;              ///< number of pickups already erased from the texture
+};
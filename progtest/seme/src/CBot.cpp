@@ -0,0 +1,55 @@
+#include "CBot.h"
+
+#include <cmath>
+
+bool CBot::isOpen(const CGameState &gamestate, std::pair<int, int> tile, CDirection direction) const
+{
+    int x = tile.first;
+    int y = tile.second;
+
+    if (direction == CDirection::up)
+        y--;
+    else if (direction == CDirection::down)
+        y++;
+    else if (direction == CDirection::left)
+        x--;
+    else if (direction == CDirection::right)
+        x++;
+
+    if (x < 0 || y < 0 || x >= gamestate.gameMap.BOARDWIDTH || y >= gamestate.gameMap.BOARDHEIGHT)
+        return true; // a tunnel
+
+    return gamestate.gameMap.getTile(x, y) != gamestate.gameMap.W;
+}
+
+bool CBot::decides(const CGameState &gamestate, CPos pos) const
+{
+    // the decision is made half a tile ahead, so that the move is cached before the player reaches the tile center
+    std::pair<int, int> tile = {static_cast<int>(round(pos.x)), static_cast<int>(round(pos.y))};
+
+    return tile != lastTile || !gamestate.gameMap.graph.isLegal(gamestate.thisMove, pos) || gamestate.thisMove == CDirection::none;
+}
+
+void CBot::update(CGameState &gamestate)
+{
+    if (!decides(gamestate, gamestate.playerPos))
+        return;
+
+    std::pair<int, int> tile = {static_cast<int>(round(gamestate.playerPos.x)), static_cast<int>(round(gamestate.playerPos.y))};
+    lastTile = tile;
+
+    CDirection candidates[4];
+    int candidateCount = 0;
+
+    for (CDirection direction : {CDirection::up, CDirection::left, CDirection::down, CDirection::right})
+        if (isOpen(gamestate, tile, direction) && direction != opposite(gamestate.thisMove))
+            candidates[candidateCount++] = direction;
+
+    if (candidateCount == 0) // a dead end, the only way is back
+    {
+        gamestate.nextMove = opposite(gamestate.thisMove);
+        return;
+    }
+
+    gamestate.nextMove = candidates[std::uniform_int_distribution<int>(0, candidateCount - 1)(rng)];
+}
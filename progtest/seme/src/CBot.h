@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CGameState.h"
+
+#include <random>
+#include <utility>
+
+/** \class CBot
+A scripted player used by the headless tools. It wanders the maze, picking a random open direction every time it enters a new tile.
+
+The bot is seeded, so a game played by it is reproducible.
+*/
+class CBot
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Constructor that seeds the bot
+    ///
+    /// @param [in] seed seed of the random number generator
+    CBot(unsigned int seed) : rng(seed){};
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Picks the next move of the player. Called before every update of the game.
+    ///
+    /// @param [out] gamestate a gamestate instance, its nextMove is set
+    void update(CGameState &gamestate);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Checks if the bot would pick a new move with the player at a position, i.e. if update would not return right away.
+    ///
+    /// @param [in] gamestate a gamestate instance
+    /// @param [in] pos the position of the player
+    bool decides(const CGameState &gamestate, CPos pos) const;
+
+private:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Checks if there is no wall next to a tile in the given direction. Leaving the board is allowed, as it leads through a tunnel.
+    ///
+    /// @param [in] gamestate a gamestate instance
+    /// @param [in] tile the tile
+    /// @param [in] direction the direction
+    bool isOpen(const CGameState &gamestate, std::pair<int, int> tile, CDirection direction) const;
+
+    std::mt19937 rng;                        ///< random number generator
+    std::pair<int, int> lastTile = {-1, -1}; ///< the tile where the last decision was made
+};
@@ -0,0 +1,43 @@
+#include "CCamera.h"
+
+#include <algorithm>
+#include <cmath>
+
+CCamera::CCamera(const CGameState &gamestate)
+{
+    resize(gamestate);
+}
+
+void CCamera::resize(const CGameState &gamestate)
+{
+    viewWidth = gamestate.VIEW_WIDTH;
+    viewHeight = gamestate.VIEW_HEIGHT;
+    boardWidth = gamestate.gameMap.BOARDWIDTH;
+    boardHeight = gamestate.gameMap.BOARDHEIGHT;
+    origin = CPos(0, 0);
+}
+
+void CCamera::follow(CPos target)
+{
+    // the target is the top left corner of its tile, its center is half a tile further
+    origin.x = std::clamp(target.x + 0.5 - viewWidth / 2.0, 0.0, static_cast<double>(boardWidth - viewWidth));
+    origin.y = std::clamp(target.y + 0.5 - viewHeight / 2.0, 0.0, static_cast<double>(boardHeight - viewHeight));
+}
+
+CPos CCamera::getOrigin() const
+{
+    return origin;
+}
+
+bool CCamera::showsWholeBoard() const
+{
+    return viewWidth >= boardWidth && viewHeight >= boardHeight;
+}
+
+void CCamera::getVisibleTiles(int &left, int &top, int &right, int &bottom) const
+{
+    left = std::max(0, static_cast<int>(std::floor(origin.x)));
+    top = std::max(0, static_cast<int>(std::floor(origin.y)));
+    right = std::min(boardWidth, static_cast<int>(std::ceil(origin.x + viewWidth)));
+    bottom = std::min(boardHeight, static_cast<int>(std::ceil(origin.y + viewHeight)));
+}
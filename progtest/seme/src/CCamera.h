@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CPos.h"
+#include "CGameState.h"
+
+/** \class CCamera
+The part of the board that is shown in the window. It follows the player over boards larger than the window and stops at the board's edges.
+
+Everything is in tiles, the canvas converts it to pixels.
+*/
+class CCamera
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Constructor that sizes the view
+    ///
+    /// @param [in] gamestate a gamestate instance. Used to read the view and board dimensions.
+    CCamera(const CGameState &gamestate);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Reads the view and board dimensions again and moves the view to the top left corner. Has to be called whenever they change.
+    ///
+    /// @param [in] gamestate a gamestate instance. Used to read the view and board dimensions.
+    void resize(const CGameState &gamestate);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Centers the view on a position, as far as the edges of the board allow.
+    ///
+    /// @param [in] target the position, usually the player's
+    void follow(CPos target);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the board position shown in the top left corner of the window.
+    CPos getOrigin() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Checks if the whole board fits into the view, the camera then never moves.
+    bool showsWholeBoard() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the tiles that are at least partly visible, as a range of columns and rows.
+    ///
+    /// @param [out] left the first visible column
+    /// @param [out] top the first visible row
+    /// @param [out] right one past the last visible column
+    /// @param [out] bottom one past the last visible row
+    void getVisibleTiles(int &left, int &top, int &right, int &bottom) const;
+
+private:
+    CPos origin;         ///< board position of the top left corner of the view
+    int viewWidth = 0;   ///< width of the view in tiles
+    int viewHeight = 0;  ///< height of the view in tiles
+    int boardWidth = 0;  ///< width of the board in tiles
+    int boardHeight = 0; ///< height of the board in tiles
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CPos.h"
+
+/** \class CCanvas
+An abstract drawing surface. Game objects draw themselves through it, so that the simulation does not depend on SDL.
+*/
+class CCanvas
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Default destructor
+    virtual ~CCanvas() = default;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// An abstract method, it's implementation will fill a square centered in the tile at the given position
+    ///
+    /// @param [in] pos position on the game board, in tiles
+    /// @param [in] scale size of the square relative to the size of a tile
+    /// @param [in] R red
+    /// @param [in] G green
+    /// @param [in] B blue
+    virtual void fillTile(CPos pos, double scale, int R, int G, int B) = 0;
+};
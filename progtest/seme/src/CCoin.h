@@ -5,26 +5,19 @@
 /** \class CCoin
 A class that represents a coin that increases player score on collection.
 */
-class CCoin : public CCollectible
+class CCoin
 {
 public:
     ////////////////////////////////////////////////////////////////////////////////
-    /// Constructor that creates the coin at a specified position
+    /// Draws the coin on the screen at a position.
     ///
-    /// @param [in] pos position
-    CCoin(CPos pos) : CCollectible(pos){};
+    /// @param [in] canvas the canvas to draw on
+    /// @param [in] pos position of the coin
+    static void draw(CCanvas &canvas, CPos pos);
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// Draws the coin on the screen according to it's position.
-    ///
-    /// @param [in] renderer a pointer to the SDL_Renderer
-    /// @param [in] gamestate a gamestate instance
-    virtual void draw(SDL_Renderer *renderer, CGameState &gamestate) override;
-
-private:
-    ////////////////////////////////////////////////////////////////////////////////
-    /// Implementation of the abstract doEffect, gives player a +1 score
+    /// Does the effect of the coin, gives player a +1 score
     ///
     /// @param [out] gamestate a gamestate instance
-    virtual void doEffect(CGameState &gamestate) override;
+    static void doEffect(CGameState &gamestate);
 };
\ No newline at end of file
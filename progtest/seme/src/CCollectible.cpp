@@ -1,10 +1,34 @@
 #include "CCollectible.h"
 
-void CCollectible::update(CGameState &gamestate, double deltaTime)
+#include "CCoin.h"
+#include "CPowerUp.h"
+
+void CCollectible::collect(CKind kind, CGameState &gamestate)
+{
+    switch (kind)
+    {
+    case CKind::coin:
+        CCoin::doEffect(gamestate);
+        break;
+    case CKind::powerUp:
+        CPowerUp::doEffect(gamestate);
+        break;
+    case CKind::none:
+        break;
+    }
+}
+
+void CCollectible::draw(CKind kind, CCanvas &canvas, CPos pos)
 {
-    if (gamestate.playerPos == pos)
+    switch (kind)
     {
-        doEffect(gamestate);
-        collected = true;
+    case CKind::coin:
+        CCoin::draw(canvas, pos);
+        break;
+    case CKind::powerUp:
+        CPowerUp::draw(canvas, pos);
+        break;
+    case CKind::none:
+        break;
     }
-}
\ No newline at end of file
+}
@@ -1,32 +1,37 @@
 #pragma once
-#include "CGameObject.h"
+#include "CGameState.h"
+#include "CCanvas.h"
+
+#include <cstdint>
 
 /** \class CCollectible
-An abstract class that serves as the parent class of individual collectible items.
+The kinds of collectible items. CCollectibleGrid stores a kind per tile and dispatches to the individual collectible classes through it.
 */
-class CCollectible : public CGameObject
+class CCollectible
 {
 public:
-    ////////////////////////////////////////////////////////////////////////////////
-    /// Constructor that creates the collectible at a specified position
-    ///
-    /// @param [in] pos position
-    CCollectible(CPos pos) : pos(pos){};
+    /** \class CKind
+    The collectible kinds, stored in a single byte per tile.
+    */
+    enum class CKind : uint8_t
+    {
+        none,   ///< no collectible
+        coin,   ///< CCoin
+        powerUp ///< CPowerUp
+    };
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// Checks collision with the player and if a collision is detected, does the appropriate effect
+    /// Called by CCollectibleGrid when the player enters the collectible's tile. Does the appropriate effect.
     ///
-    /// @param [in] renderer a pointer to the SDL_Renderer
-    /// @param [in] deltaTime time since last frame
-    virtual void update(CGameState &gamestate, double deltaTime) override;
+    /// @param [in] kind the kind of the collectible
+    /// @param [in, out] gamestate a gamestate instance
+    static void collect(CKind kind, CGameState &gamestate);
 
-protected:
     ////////////////////////////////////////////////////////////////////////////////
-    ///  An abstract method, it's implementation will give the player the appropriate effect
+    /// Draws a collectible that was not collected yet.
     ///
-    /// @param [out] gamestate a gamestate instance
-    virtual void doEffect(CGameState &gamestate) = 0;
-
-    CPos pos;               ///< the position of the collectible
-    bool collected = false; ///< a bool that indicates if the collectible was collected by a player
-};
\ No newline at end of file
+    /// @param [in] kind the kind of the collectible
+    /// @param [in] canvas the canvas to draw on
+    /// @param [in] pos the position of the collectible
+    static void draw(CKind kind, CCanvas &canvas, CPos pos);
+};
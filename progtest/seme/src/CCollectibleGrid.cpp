@@ -0,0 +1,145 @@
+#include "CCollectibleGrid.h"
+#include "CGameSnapshot.h"
+
+#include <cmath>
+
+void CCollectibleGrid::reset(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+
+    kinds.assign(width * height, CCollectible::CKind::none);
+    pickups.clear();
+    count = 0;
+    generation++;
+    collected.assign((width * height + 63) / 64, ~0ull); // the padding bits of the last word stay set, so they are never drawn
+}
+
+void CCollectibleGrid::restore(const CCollectibleGrid &initial)
+{
+    width = initial.width;
+    height = initial.height;
+
+    kinds = initial.kinds;
+    collected = initial.collected;
+    count = initial.count;
+    pickups.clear();
+    pickups.reserve(count);
+    generation++;
+}
+
+void CCollectibleGrid::follow(const CCollectibleGrid &source)
+{
+    if (generation != source.generation || pickups.size() > source.pickups.size())
+    {
+        restore(source);
+        generation = source.generation;
+    }
+
+    for (size_t i = pickups.size(); i < source.pickups.size(); i++)
+    {
+        int tile = source.pickups[i].second * width + source.pickups[i].first;
+        collected[tile / 64] |= 1ull << (tile % 64);
+        pickups.push_back(source.pickups[i]);
+    }
+}
+
+void CCollectibleGrid::add(CCollectible::CKind kind, int x, int y)
+{
+    int tile = y * width + x;
+
+    if (kinds[tile] == CCollectible::CKind::none)
+        count++;
+
+    kinds[tile] = kind;
+    collected[tile / 64] &= ~(1ull << (tile % 64));
+}
+
+void CCollectibleGrid::update(CGameState &gamestate)
+{
+    int x = static_cast<int>(round(gamestate.playerPos.x));
+    int y = static_cast<int>(round(gamestate.playerPos.y));
+
+    if (x < 0 || y < 0 || x >= width || y >= height) // in a tunnel
+        return;
+
+    int tile = y * width + x;
+    if (collected[tile / 64] & (1ull << (tile % 64)))
+        return;
+
+    collected[tile / 64] |= 1ull << (tile % 64);
+    pickups.push_back({x, y});
+    CCollectible::collect(kinds[tile], gamestate);
+}
+
+void CCollectibleGrid::draw(CCanvas &canvas, int left, int top, int right, int bottom) const
+{
+    for (int y = top; y < bottom; y++)
+    {
+        int first = y * width + left;
+        int last = y * width + right; // one past the last tile
+
+        for (int word = first / 64; word * 64 < last; word++)
+        {
+            uint64_t remaining = ~collected[word];
+
+            // the parts of the word that belong to other rows or to the columns outside of the rectangle are masked out
+            if (word == first / 64)
+                remaining &= ~0ull << (first % 64);
+            if ((word + 1) * 64 > last)
+                remaining &= ~0ull >> (64 - last % 64);
+
+            while (remaining)
+            {
+                int tile = word * 64 + __builtin_ctzll(remaining);
+                remaining &= remaining - 1;
+
+                CCollectible::draw(kinds[tile], canvas, CPos(tile % width, tile / width));
+            }
+        }
+    }
+}
+
+bool CCollectibleGrid::isCollected(int x, int y) const
+{
+    int tile = y * width + x;
+    return collected[tile / 64] & (1ull << (tile % 64));
+}
+
+CCollectible::CKind CCollectibleGrid::getKind(int x, int y) const
+{
+    return kinds[y * width + x];
+}
+
+const std::vector<std::pair<int, int>> &CCollectibleGrid::getPickups() const
+{
+    return pickups;
+}
+
+unsigned int CCollectibleGrid::getGeneration() const
+{
+    return generation;
+}
+
+void CCollectibleGrid::saveState(CGameSnapshot &snapshot) const
+{
+    snapshot.write(width);
+    snapshot.write(height);
+    snapshot.writeArray(collected);
+}
+
+bool CCollectibleGrid::restoreState(const CGameSnapshot &snapshot, size_t &offset)
+{
+    int savedWidth = 0;
+    int savedHeight = 0;
+    size_t words = collected.size();
+
+    if (!snapshot.read(offset, savedWidth) || !snapshot.read(offset, savedHeight) ||
+        savedWidth != width || savedHeight != height ||
+        !snapshot.readArray(offset, collected) || collected.size() != words)
+        return false;
+
+    pickups.clear();
+    generation++;
+    return true;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "CCollectible.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class CGameSnapshot;
+
+/** \class CCollectibleGrid
+Holds the collectibles of a level as a grid of one byte kinds indexed by tile, together with a bitset of the tiles whose collectible was already collected.
+
+The player can only be on one tile, so a pickup is a single lookup. Collected collectibles are skipped word by word when drawing.
+*/
+class CCollectibleGrid
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Removes all collectibles and resizes the grid.
+    ///
+    /// @param [in] width width of the game board
+    /// @param [in] height height of the game board
+    void reset(int width, int height);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Makes the grid a copy of another one, e.g. of the snapshot of a level, and counts as a reset. The memory of the grid is reused when it is large enough.
+    /// Room for a pickup of every collectible is allocated too, so collecting them does not allocate.
+    ///
+    /// @param [in] initial the grid that is copied
+    void restore(const CCollectibleGrid &initial);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Brings a copy of another grid up to date, e.g. the copy the renderer draws. If the copy was made since the last reset of the other grid,
+    /// only the pickups it is missing are collected, otherwise the whole grid is copied. The copy takes over the generation of the other grid.
+    ///
+    /// @param [in] source the grid that is copied
+    void follow(const CCollectibleGrid &source);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Places a collectible on a tile.
+    ///
+    /// @param [in] kind the kind of the collectible
+    /// @param [in] x x coordinate of the tile
+    /// @param [in] y y coordinate of the tile
+    void add(CCollectible::CKind kind, int x, int y);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Collects the collectible on the player's tile, if there is one that was not collected yet.
+    ///
+    /// @param [in, out] gamestate a gamestate instance
+    void update(CGameState &gamestate);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Draws the collectibles that were not collected yet inside of a rectangle of tiles. The rest of the board is not visited at all.
+    ///
+    /// @param [in] canvas the canvas to draw on
+    /// @param [in] left the first column drawn
+    /// @param [in] top the first row drawn
+    /// @param [in] right one past the last column drawn
+    /// @param [in] bottom one past the last row drawn
+    void draw(CCanvas &canvas, int left, int top, int right, int bottom) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Checks if there is no collectible left on a tile.
+    ///
+    /// @param [in] x x coordinate of the tile
+    /// @param [in] y y coordinate of the tile
+    bool isCollected(int x, int y) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the kind of the collectible placed on a tile, collected or not.
+    ///
+    /// @param [in] x x coordinate of the tile
+    /// @param [in] y y coordinate of the tile
+    CCollectible::CKind getKind(int x, int y) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the tiles that were collected since the last reset, in the order they were collected. Lets a renderer erase them incrementally.
+    const std::vector<std::pair<int, int>> &getPickups() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns a number that changes on every reset, i.e. whenever a level is loaded.
+    unsigned int getGeneration() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Appends the collected bitset to a snapshot. The kinds belong to the level and are not saved.
+    ///
+    /// @param [out] snapshot the snapshot written to
+    void saveState(CGameSnapshot &snapshot) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Reads the collected bitset back from a snapshot. Counts as a reset, so that a renderer draws the restored collectibles again.
+    ///
+    /// @param [in] snapshot the snapshot read from
+    /// @param [in, out] offset where the state starts, moved past it
+    /// @return false if the snapshot is broken or belongs to a board of a different size
+    bool restoreState(const CGameSnapshot &snapshot, size_t &offset);
+
+private:
+    int width = 0;                            ///< width of the game board
+    int height = 0;                           ///< height of the game board
+    std::vector<CCollectible::CKind> kinds;   ///< kind of the collectible of every tile, CKind::none if there is none
+    std::vector<uint64_t> collected;          ///< one bit per tile, set if the tile has no collectible left. Tiles without a collectible are set too.
+    std::vector<std::pair<int, int>> pickups; ///< tiles collected since the last reset, the memory for all collectibles of the level is allocated by restore
+    size_t count = 0;                         ///< number of collectibles placed since the last reset
+    unsigned int generation = 0;              ///< incremented on every reset
+};
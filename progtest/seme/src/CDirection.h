@@ -10,4 +10,25 @@ enum class CDirection
     left,
     down,
     right
-};
\ No newline at end of file
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns the opposite direction. The opposite of none is none.
+///
+/// @param [in] direction a direction
+inline CDirection opposite(CDirection direction)
+{
+    switch (direction)
+    {
+    case CDirection::up:
+        return CDirection::down;
+    case CDirection::down:
+        return CDirection::up;
+    case CDirection::left:
+        return CDirection::right;
+    case CDirection::right:
+        return CDirection::left;
+    default:
+        return CDirection::none;
+    }
+}
\ No newline at end of file
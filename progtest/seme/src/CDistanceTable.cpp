@@ -0,0 +1,207 @@
+#include "CDistanceTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+constexpr char CACHE_MAGIC[4] = {'P', 'M', 'D', 'T'}; // file signature of the cache files
+constexpr uint32_t CACHE_VERSION = 1;                 // bumped whenever the file layout changes
+
+uint64_t CDistanceTable::hashMap(const CGameMap &gameMap)
+{
+    // 64-bit FNV-1a over the dimensions and the walls of the board
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](uint64_t value)
+    {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+
+    add(gameMap.BOARDWIDTH);
+    add(gameMap.BOARDHEIGHT);
+    for (int i = 0; i < gameMap.BOARDHEIGHT; i++)
+        for (int j = 0; j < gameMap.BOARDWIDTH; j++)
+            add(gameMap.getTile(j, i) == gameMap.W);
+
+    return hash;
+}
+
+std::shared_ptr<const CDistanceTable> CDistanceTable::load(const CGameMap &gameMap, const std::string &cacheDir)
+{
+    std::shared_ptr<CDistanceTable> table = std::make_shared<CDistanceTable>();
+    table->indexTiles(gameMap);
+
+    if (table->tiles.size() > MAX_TILES)
+        return nullptr;
+
+    uint64_t hash = hashMap(gameMap);
+    char fileName[64];
+    snprintf(fileName, sizeof(fileName), "/distances_%016llx.bin", static_cast<unsigned long long>(hash));
+    std::string path = cacheDir + fileName;
+
+    if (!table->readCache(path, hash))
+    {
+        table->build();
+        table->writeCache(path, hash);
+    }
+
+    return table;
+}
+
+void CDistanceTable::indexTiles(const CGameMap &gameMap)
+{
+    width = gameMap.BOARDWIDTH;
+    height = gameMap.BOARDHEIGHT;
+    tileIndex.assign(width * height, -1);
+    tiles.clear();
+
+    for (int i = 0; i < height; i++)
+        for (int j = 0; j < width; j++)
+            if (gameMap.getTile(j, i) != gameMap.W)
+            {
+                tileIndex[i * width + j] = tiles.size();
+                tiles.push_back(CPos(j, i));
+            }
+}
+
+void CDistanceTable::build()
+{
+    const int tileCount = tiles.size();
+    distances.assign(tileCount * tileCount, UNREACHABLE);
+
+    // neighbours of every tile, walking out of the board leads through a tunnel to the other side
+    std::vector<int> neighbours(tileCount * 4, -1);
+    for (int tile = 0; tile < tileCount; tile++)
+    {
+        std::pair<int, int> pos = tiles[tile].getIntPos();
+        neighbours[tile * 4 + 0] = tileIndex[((pos.second + height - 1) % height) * width + pos.first];
+        neighbours[tile * 4 + 1] = tileIndex[((pos.second + 1) % height) * width + pos.first];
+        neighbours[tile * 4 + 2] = tileIndex[pos.second * width + (pos.first + width - 1) % width];
+        neighbours[tile * 4 + 3] = tileIndex[pos.second * width + (pos.first + 1) % width];
+    }
+
+    std::vector<int> queue(tileCount);
+    for (int source = 0; source < tileCount; source++)
+    {
+        uint16_t *row = &distances[source * tileCount];
+        int head = 0;
+        int tail = 0;
+
+        row[source] = 0;
+        queue[tail++] = source;
+        while (head < tail)
+        {
+            int tile = queue[head++];
+            for (int k = 0; k < 4; k++)
+            {
+                int neighbour = neighbours[tile * 4 + k];
+                if (neighbour >= 0 && row[neighbour] == UNREACHABLE)
+                {
+                    row[neighbour] = row[tile] + 1;
+                    queue[tail++] = neighbour;
+                }
+            }
+        }
+    }
+}
+
+bool CDistanceTable::readCache(const std::string &path, uint64_t hash)
+{
+    std::ifstream cache(path, std::ios::binary);
+    if (!cache.is_open())
+        return false;
+
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t fileHash = 0;
+    uint32_t tileCount = 0;
+
+    cache.read(magic, sizeof(magic));
+    cache.read(reinterpret_cast<char *>(&version), sizeof(version));
+    cache.read(reinterpret_cast<char *>(&fileHash), sizeof(fileHash));
+    cache.read(reinterpret_cast<char *>(&tileCount), sizeof(tileCount));
+
+    if (!cache ||
+        !std::equal(magic, magic + 4, CACHE_MAGIC) ||
+        version != CACHE_VERSION ||
+        fileHash != hash ||
+        tileCount != tiles.size())
+        return false;
+
+    distances.resize(tileCount * tileCount);
+    cache.read(reinterpret_cast<char *>(distances.data()), distances.size() * sizeof(uint16_t));
+
+    if (!cache) // a truncated file, the table is rebuilt
+    {
+        distances.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void CDistanceTable::writeCache(const std::string &path, uint64_t hash) const
+{
+    // written to a temporary file first, so that a reader never sees half of a table
+    std::string temporaryPath = path + ".tmp";
+    std::ofstream cache(temporaryPath, std::ios::binary);
+    if (!cache.is_open())
+        return;
+
+    uint32_t tileCount = tiles.size();
+
+    cache.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    cache.write(reinterpret_cast<const char *>(&CACHE_VERSION), sizeof(CACHE_VERSION));
+    cache.write(reinterpret_cast<const char *>(&hash), sizeof(hash));
+    cache.write(reinterpret_cast<const char *>(&tileCount), sizeof(tileCount));
+    cache.write(reinterpret_cast<const char *>(distances.data()), distances.size() * sizeof(uint16_t));
+    cache.close();
+
+    if (cache)
+        std::rename(temporaryPath.c_str(), path.c_str());
+    else
+        std::remove(temporaryPath.c_str());
+}
+
+int CDistanceTable::getIndex(CPos pos) const
+{
+    int x = static_cast<int>(round(pos.x));
+    int y = static_cast<int>(round(pos.y));
+
+    x = ((x % width) + width) % width;
+    y = ((y % height) + height) % height;
+
+    return tileIndex[y * width + x];
+}
+
+int CDistanceTable::getDistance(CPos from, CPos to) const
+{
+    int fromIndex = getIndex(from);
+    int toIndex = getIndex(to);
+
+    if (fromIndex < 0 || toIndex < 0)
+        return -1;
+
+    uint16_t distance = distances[fromIndex * tiles.size() + toIndex];
+    return distance == UNREACHABLE ? -1 : distance;
+}
+
+CPos CDistanceTable::getNearestTile(CPos pos) const
+{
+    CPos nearest = pos;
+    double nearestDistance = std::numeric_limits<double>::max();
+
+    for (const CPos &tile : tiles)
+    {
+        double distance = std::hypot(tile.x - pos.x, tile.y - pos.y);
+        if (distance < nearestDistance)
+        {
+            nearestDistance = distance;
+            nearest = tile;
+        }
+    }
+
+    return nearest;
+}
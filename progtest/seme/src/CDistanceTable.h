@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CPos.h"
+#include "CGameMap.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/** \class CDistanceTable
+Shortest path distances (in tiles) between all pairs of walkable tiles of a game board, tunnels included.
+
+The table is built once when a map is loaded and cached on disk, keyed by a hash of the map, so that a distance is a single lookup afterwards.
+Only walkable tiles are indexed and the distances are stored as 16-bit integers.
+*/
+class CDistanceTable
+{
+public:
+    static constexpr int MAX_TILES = 4096; ///< Maps with more walkable tiles than this get no table (it would take 32 MB), callers fall back to vector norms.
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Builds the table for a map. Reads it from the cache directory if it was built before, otherwise builds it and stores it there.
+    ///
+    /// @param [in] gameMap the game board
+    /// @param [in] cacheDir directory of the cache files. If the directory does not exist, the table is not cached.
+    /// @return the table, or nullptr if the map is too large
+    static std::shared_ptr<const CDistanceTable> load(const CGameMap &gameMap, const std::string &cacheDir);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns a hash of the walls of a map. Used as the cache key.
+    ///
+    /// @param [in] gameMap the game board
+    static uint64_t hashMap(const CGameMap &gameMap);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the maze distance between two positions, both rounded to the nearest tile. Positions outside of the board are wrapped around.
+    ///
+    /// @param [in] from the first position
+    /// @param [in] to the second position
+    /// @return the distance in tiles, or -1 if one of the tiles is a wall or they are not connected
+    int getDistance(CPos from, CPos to) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the walkable tile closest (by euclidean distance) to a position. Used to turn targets outside of the maze into reachable ones.
+    ///
+    /// @param [in] pos the position, it can be outside of the board
+    CPos getNearestTile(CPos pos) const;
+
+private:
+    static constexpr uint16_t UNREACHABLE = 0xFFFF; ///< stored distance of tiles that are not connected
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Indexes the walkable tiles of the map.
+    ///
+    /// @param [in] gameMap the game board
+    void indexTiles(const CGameMap &gameMap);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Fills the distances with a breadth first search from every walkable tile.
+    void build();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Reads the distances from a cache file.
+    ///
+    /// @param [in] path path to the cache file
+    /// @param [in] hash hash of the map the file must belong to
+    /// @return true if the file was read and belongs to the map
+    bool readCache(const std::string &path, uint64_t hash);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Writes the distances to a cache file.
+    ///
+    /// @param [in] path path to the cache file
+    /// @param [in] hash hash of the map
+    void writeCache(const std::string &path, uint64_t hash) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the index of the tile nearest to a position, or -1 if it is a wall.
+    ///
+    /// @param [in] pos the position, wrapped around if outside of the board
+    int getIndex(CPos pos) const;
+
+    int width = 0;                   ///< width of the board
+    int height = 0;                  ///< height of the board
+    std::vector<int> tileIndex;      ///< index of every tile of the board in the table, -1 for walls
+    std::vector<CPos> tiles;         ///< positions of the indexed tiles
+    std::vector<uint16_t> distances; ///< tiles.size() * tiles.size() distances, row by row
+};
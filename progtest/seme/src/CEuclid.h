@@ -2,35 +2,39 @@
 
 #include "CGhost.h"
 
+#include <cmath>
+
 /** \class CEuclid
-A ghost class that will use the euclidean vector norm for pathfinding
+A ghost personality that will use the euclidean vector norm for pathfinding. Passed to CGhost as a template parameter, everything is defined inline so that it is compiled into the ghosts' decisions.
 */
-class CEuclid : public CGhost
+class CEuclid
 {
 public:
-    ////////////////////////////////////////////////////////////////////////////////
-    /// Constructor that creates Euclid at the specified position.
-    ///
-    /// @param [in] pos initial position
-    CEuclid(CPos pos) : CGhost(pos){};
-
-    ////////////////////////////////////////////////////////////////////////////////
-    /// Draws Euclid on the screen according to his current position.
-    ///
-    /// @param [in] renderer a pointer to the SDL_Renderer
-    /// @param [in] gamestate a gamestate instance
-    virtual void draw(SDL_Renderer *renderer, CGameState &gamestate) override;
+    static constexpr int R = 150;                                ///< red component of Euclid's color
+    static constexpr int G = 0;                                  ///< green component of Euclid's color
+    static constexpr int B = 60;                                 ///< blue component of Euclid's color
+    static constexpr char GLYPH = 'e';                           ///< the glyph of Euclid's start position in the map
+    static constexpr CGameMap::CMapObjects OBJECT = CGameMap::e; ///< the map object of Euclid's start position
 
-protected:
     ////////////////////////////////////////////////////////////////////////////////
-    /// Returns the standart (Euclidean) norm of a position that is interpreted as a vector
+    /// Returns the euclidean norm of a position that is interpreted as a vector
     ///
     /// @param[in] position a 2-d vector
-    virtual double getNorm(CPos position) override;
+    static double getNorm(CPos position);
 
     ////////////////////////////////////////////////////////////////////////////////
     /// Returns the position Euclid wants to take when he's in guard mode.
     ///
     /// @param[in] gamestate a gamestate instance
-    virtual CPos getGuardPos(CGameState &gamestate) override;
-};
\ No newline at end of file
+    static CPos getGuardPos(const CGameState &gamestate);
+};
+
+inline double CEuclid::getNorm(CPos position)
+{
+    return std::hypot(position.x, position.y);
+}
+
+inline CPos CEuclid::getGuardPos(const CGameState &gamestate)
+{
+    return CPos(0, 0);
+}
@@ -0,0 +1,385 @@
+#include "CEventSimulation.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+constexpr double GRID = 0x1p32;  // values on a grid of 1 / GRID ...
+constexpr double RANGE = 0x1p20; // ... that stay below RANGE are added without rounding
+
+CEventSimulation::CEventSimulation(const CGameState &gamestate, unsigned int seed, CReplay *recording)
+    : bot(seed), recording(recording)
+{
+    game.gamestate = gamestate;
+    game.setup();
+    game.gamestate.screen = CGameState::CScreen::playing;
+
+    if (recording)
+    {
+        recording->begin(game.gamestate);
+        game.recorder = recording;
+    }
+}
+
+CGameResult CEventSimulation::play()
+{
+    // the loop of CSimulation::play checks the time limit before every step
+    stepLimit = 1 + countSteps(0, CGame::TICK, static_cast<long long>(CSimulation::TIME_LIMIT / CGame::TICK) + 1, [](double time)
+                               { return time < CSimulation::TIME_LIMIT; });
+    planAll();
+
+    while (game.gamestate.screen == CGameState::CScreen::playing && time < CSimulation::TIME_LIMIT)
+    {
+        // the bot picks its move at the start of a step, before the game does anything. Its decisions do not need the step to be taken,
+        // only the moves they lead to
+        if (bot.decides(game.gamestate, game.gamestate.playerPos))
+        {
+            bot.update(game.gamestate);
+            plan(0, true);
+        }
+
+        long long quietSteps = findQuietSteps();
+        if (quietSteps > 0)
+            skip(quietSteps);
+        else
+            take();
+    }
+
+    if (recording)
+        recording->finish(game.gamestate);
+
+    CGameResult result;
+    result.score = game.gamestate.score;
+    result.level = game.gamestate.level;
+    result.time = time;
+    result.over = game.gamestate.screen == CGameState::CScreen::gameOver;
+    return result;
+}
+
+long long CEventSimulation::getTakenSteps() const
+{
+    return takenSteps;
+}
+
+long long CEventSimulation::getSkippedSteps() const
+{
+    return skippedSteps;
+}
+
+CPos &CEventSimulation::getPos(size_t actor)
+{
+    if (actor == 0)
+        return game.gamestate.playerPos;
+
+    return game.ghosts.getKind(actors[actor].kind).currentPos[actors[actor].index];
+}
+
+void CEventSimulation::planAll()
+{
+    actors.resize(1 + game.ghosts.size());
+
+    size_t actor = 1;
+    for (size_t kind = 0; kind < CGhostStore::KIND_COUNT; kind++)
+        for (size_t index = 0; index < game.ghosts.getKind(kind).size(); index++, actor++)
+        {
+            actors[actor].kind = kind;
+            actors[actor].index = index;
+        }
+
+    events = {};
+    for (size_t i = 0; i < actors.size(); i++)
+        plan(i, false);
+
+    planTimers();
+}
+
+void CEventSimulation::plan(size_t actor, bool followed)
+{
+    const CGameState &gamestate = game.gamestate;
+    CActor &plan = actors[actor];
+    CPos pos = getPos(actor);
+    CDirection direction = actor == 0 ? gamestate.thisMove : game.ghosts.getKind(plan.kind).direction[plan.index];
+    double distance = (actor == 0 ? gamestate.PLAYER_SPEED : CGhost::getSpeed(gamestate)) * CGame::TICK;
+    double dx = direction == CDirection::left ? -distance : direction == CDirection::right ? distance : 0;
+    double dy = direction == CDirection::up ? -distance : direction == CDirection::down ? distance : 0;
+    bool turned = !followed || dx != plan.dx || dy != plan.dy;
+
+    plan.direction = direction;
+    plan.dx = dx;
+    plan.dy = dy;
+
+    // moving through a tunnel is not a change of a coordinate that could be skipped over
+    auto isOutside = [&gamestate](CPos at)
+    {
+        return at.x < -1 || at.y < -1 || at.x > gamestate.gameMap.BOARDWIDTH || at.y > gamestate.gameMap.BOARDHEIGHT;
+    };
+
+    // the player can enter a position if the move is not replaced by the next one there and if there is at most a coin to collect,
+    // which skip collects. It stays quiet while the bot keeps its move and the move is not stopped by a wall
+    auto canPlayerEnter = [&](CPos at)
+    {
+        int x = static_cast<int>(round(at.x));
+        int y = static_cast<int>(round(at.y));
+        bool onBoard = x >= 0 && y >= 0 && x < gamestate.gameMap.BOARDWIDTH && y < gamestate.gameMap.BOARDHEIGHT;
+
+        return !isOutside(at) &&
+               (gamestate.nextMove == gamestate.thisMove || !gamestate.gameMap.graph.isLegal(gamestate.nextMove, at)) &&
+               (!onBoard || game.collectibles.isCollected(x, y) || game.collectibles.getKind(x, y) == CCollectible::CKind::coin);
+    };
+    auto isPlayerQuiet = [&](CPos at)
+    {
+        int x = static_cast<int>(round(at.x));
+        int y = static_cast<int>(round(at.y));
+        bool onBoard = x >= 0 && y >= 0 && x < gamestate.gameMap.BOARDWIDTH && y < gamestate.gameMap.BOARDHEIGHT;
+
+        return canPlayerEnter(at) &&
+               (!onBoard || game.collectibles.isCollected(x, y)) &&
+               !bot.decides(gamestate, at) &&
+               gamestate.gameMap.graph.isLegal(gamestate.thisMove, at);
+    };
+
+    // a ghost is quiet while it follows a corridor, its collisions with the player are found separately. It decides at the start of an update,
+    // so it can enter any position except for a tunnel end. Inside the corridor it entered at its last decision, it is not even looked at
+    CCorridor corridor = actor == 0 ? CCorridor() : game.ghosts.getKind(plan.kind).corridor[plan.index];
+    auto isGhostQuiet = [&](CPos at)
+    {
+        CPos nextPos;
+        return !isOutside(at) && (CGhost::isInCorridor(at, direction, corridor) || CGhost::isCruising(gamestate, at, direction, nextPos));
+    };
+
+    long long limit = stepLimit - step;
+    long long quietSteps = actor == 0 ? findQuietMoves(pos, plan.dx, plan.dy, limit, isPlayerQuiet, canPlayerEnter)
+                                      : findQuietMoves(pos, plan.dx, plan.dy, limit, isGhostQuiet, [&](CPos at)
+                                                       { return !isOutside(at); });
+
+    plan.version++;
+    plan.end = step + quietSteps;
+    events.push({plan.end, actor, plan.version});
+
+    // a meeting stays where it was found as long as the ghost and the player both keep on moving in their straight lines
+    if (!turned)
+        return;
+
+    plan.motion++;
+    if (actor == 0)
+        planMeetings();
+    else
+        planMeeting(actor);
+}
+
+void CEventSimulation::planMeeting(size_t actor)
+{
+    long long meeting = findMeeting(actors[actor], actors[0]);
+    if (meeting >= 0)
+        meetings.push({step + meeting, actor, actors[actor].motion});
+}
+
+void CEventSimulation::planMeetings()
+{
+    meetings = {};
+    for (size_t actor = 1; actor < actors.size(); actor++)
+        planMeeting(actor);
+}
+
+void CEventSimulation::planTimers()
+{
+    const CGameState &gamestate = game.gamestate;
+    long long quietSteps = stepLimit - step;
+
+    // the mode timers are counted down by updatePlaying, nothing but the step of an event can set them again
+    if (gamestate.powerUpRemaining > 0)
+        quietSteps = std::min(quietSteps, countSteps(gamestate.powerUpRemaining, -CGame::TICK, quietSteps, [](double time)
+                                                     { return time > 0; }));
+
+    if (gamestate.guardTimeRemaining > 0)
+        quietSteps = std::min(quietSteps, countSteps(gamestate.guardTimeRemaining, -CGame::TICK, quietSteps, [](double time)
+                                                     { return time > 0; }));
+
+    if (gamestate.gamemode != CGameState::CGameMode::powerup)
+        quietSteps = std::min(quietSteps, countSteps(gamestate.nextGuard, -CGame::TICK, quietSteps, [](double time)
+                                                     { return time >= 0; }));
+
+    timersEnd = step + quietSteps;
+}
+
+long long CEventSimulation::findQuietSteps()
+{
+    // the level is set up at the start of the step after the last coin was collected
+    if (game.gamestate.gameMap.coinCount == 0)
+        return 0;
+
+    long long quietSteps = timersEnd - step;
+
+    while (!events.empty() && events.top().version != actors[events.top().actor].version)
+        events.pop();
+
+    if (!events.empty())
+        quietSteps = std::min(quietSteps, events.top().step - step);
+
+    // a meeting that was already taken may go on in the following steps, while the ghost and the player are less than a tile apart
+    while (!meetings.empty() && (meetings.top().version != actors[meetings.top().actor].motion || meetings.top().step < step))
+    {
+        CEvent meeting = meetings.top();
+        meetings.pop();
+        if (meeting.version == actors[meeting.actor].motion)
+            planMeeting(meeting.actor);
+    }
+
+    if (!meetings.empty())
+        quietSteps = std::min(quietSteps, meetings.top().step - step);
+
+    return std::max(quietSteps, 0ll);
+}
+
+void CEventSimulation::skip(long long steps)
+{
+    CGameState &gamestate = game.gamestate;
+
+    if (recording)
+        recording->record(gamestate, steps);
+
+    // the previous positions are the ones before the last skipped step, where the renderer would interpolate from
+    CPos &playerPos = gamestate.playerPos;
+    gamestate.previousPlayerPos = CPos(advance(playerPos.x, actors[0].dx, steps - 1), advance(playerPos.y, actors[0].dy, steps - 1));
+    playerPos = CPos(advance(playerPos.x, actors[0].dx, steps), advance(playerPos.y, actors[0].dy, steps));
+
+    for (size_t actor = 1; actor < actors.size(); actor++)
+    {
+        const CActor &plan = actors[actor];
+        CGhostArrays &ghosts = game.ghosts.getKind(plan.kind);
+        CPos &currentPos = ghosts.currentPos[plan.index];
+
+        ghosts.previousPos[plan.index] = CPos(advance(currentPos.x, plan.dx, steps - 1), advance(currentPos.y, plan.dy, steps - 1));
+        currentPos = CPos(advance(currentPos.x, plan.dx, steps), advance(currentPos.y, plan.dy, steps));
+        ghosts.grid.move(plan.index, currentPos);
+        CGhost::isCruising(gamestate, ghosts.previousPos[plan.index], plan.direction, ghosts.nextPos[plan.index]);
+    }
+
+    // the last step may have taken the player onto a coin
+    game.collectibles.update(gamestate);
+
+    gamestate.nextGuard = advance(gamestate.nextGuard, -CGame::TICK, steps);
+    if (gamestate.powerUpRemaining > 0)
+        gamestate.powerUpRemaining = advance(gamestate.powerUpRemaining, -CGame::TICK, steps);
+    if (gamestate.guardTimeRemaining > 0)
+        gamestate.guardTimeRemaining = advance(gamestate.guardTimeRemaining, -CGame::TICK, steps);
+
+    step += steps;
+    skippedSteps += steps;
+    time = advance(time, CGame::TICK, steps);
+}
+
+void CEventSimulation::take()
+{
+    CGameState &gamestate = game.gamestate;
+    CGameState::CGameMode gamemode = gamestate.gamemode;
+    int level = gamestate.level;
+
+    // where the actors end up if the step goes by their plans
+    for (size_t actor = 0; actor < actors.size(); actor++)
+    {
+        CPos pos = getPos(actor);
+        actors[actor].expected = CPos(pos.x + actors[actor].dx, pos.y + actors[actor].dy);
+    }
+
+    game.step();
+    step++;
+    takenSteps++;
+    time += CGame::TICK;
+
+    // a new speed of the ghosts or a new level changes every plan
+    if (gamestate.gamemode != gamemode || gamestate.level != level)
+    {
+        planAll();
+        return;
+    }
+
+    planTimers();
+
+    // an actor is planned again when its event was due, or when the step did something else to it than its plan: the player took its next move,
+    // a ghost turned or was eaten. A new move of the bot is planned in play, before the step
+    for (size_t actor = 0; actor < actors.size(); actor++)
+    {
+        const CActor &planned = actors[actor];
+        CPos pos = getPos(actor);
+        CDirection direction = actor == 0 ? gamestate.thisMove : game.ghosts.getKind(planned.kind).direction[planned.index];
+        bool followed = pos.x == planned.expected.x && pos.y == planned.expected.y;
+
+        if (planned.end < step || !followed || direction != planned.direction)
+            plan(actor, followed);
+    }
+}
+
+long long CEventSimulation::findMeeting(const CActor &ghost, const CActor &player) const
+{
+    CPos ghostPos = game.ghosts.getKind(ghost.kind).currentPos[ghost.index];
+    CPos playerPos = game.gamestate.playerPos;
+
+    // a ghost checks the collision before it moves, after the player has moved, so after k steps it is
+    // ghostPos + k * ghost's change against playerPos + (k + 1) * player's change
+    long long first = 0;
+    long long last = LLONG_MAX;
+
+    for (int axis = 0; axis < 2; axis++)
+    {
+        double offset = axis == 0 ? ghostPos.x - playerPos.x - player.dx : ghostPos.y - playerPos.y - player.dy;
+        double approach = axis == 0 ? ghost.dx - player.dx : ghost.dy - player.dy;
+
+        // two coordinates a tile or more apart are never rounded to the same tile
+        if (approach == 0)
+        {
+            if (std::fabs(offset) >= 1)
+                return -1;
+            continue;
+        }
+
+        double from = (-1 - offset) / approach;
+        double to = (1 - offset) / approach;
+        if (from > to)
+            std::swap(from, to);
+
+        // widened by a step on both sides, so that no rounding of the division can miss a collision
+        if (to + 1 < 0)
+            return -1;
+        if (from - 1 > static_cast<double>(LLONG_MAX / 2))
+            return -1;
+
+        first = std::max(first, static_cast<long long>(std::max(std::floor(from) - 1, 0.0)));
+        last = std::min(last, static_cast<long long>(std::min(std::ceil(to) + 1, static_cast<double>(LLONG_MAX / 2))));
+    }
+
+    return first <= last ? first : -1;
+}
+
+double CEventSimulation::advance(double value, double delta, long long steps)
+{
+    if (isExact(value, delta, steps))
+        return value + steps * delta;
+
+    for (long long i = 0; i < steps; i++)
+        value += delta;
+
+    return value;
+}
+
+bool CEventSimulation::isExact(double value, double delta, long long steps)
+{
+    double scaledValue = value * GRID;
+    double scaledDelta = delta * GRID;
+
+    return scaledValue == std::trunc(scaledValue) &&
+           scaledDelta == std::trunc(scaledDelta) &&
+           std::fabs(value) + static_cast<double>(steps) * std::fabs(delta) < RANGE;
+}
+
+CEventSimulation::CCell CEventSimulation::getCell(double coordinate, int size)
+{
+    CCell cell;
+    cell.tile = static_cast<int>(coordinate);
+    double fraction = coordinate - cell.tile;
+    cell.nearTile = fraction < CMazeGraph::THRESHOLD;
+    cell.farTile = fraction > CMazeGraph::THRESHOLD;
+    cell.rounded = static_cast<int>(round(coordinate));
+    cell.outside = coordinate < -1 || coordinate > size;
+    return cell;
+}
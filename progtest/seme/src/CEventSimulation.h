@@ -0,0 +1,314 @@
+#pragma once
+
+#include "CGame.h"
+#include "CBot.h"
+#include "CSimulation.h"
+
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+/** \class CEventSimulation
+Plays a game of the bot like CSimulation::play, with the same result, without taking most of its steps.
+
+Between two decisions the player and the ghosts move in straight lines and the mode timers only count down. For every actor, the simulation finds the step in which
+it next reaches a position where it could decide something (a junction or a corner for a ghost, a new tile for the player), and keeps these events in a priority queue.
+The steps in which a mode timer expires and in which the player comes close to a ghost are events too. The meetings of the ghosts with the player have a queue
+of their own, a meeting only changes when the ghost or the player leaves its straight line. All steps before the nearest event are skipped at once:
+positions and timers are advanced by the number of skipped steps. The step of the event itself is taken by CGame::step as usual, so every decision is made by
+the same code as in the fixed-step simulation.
+
+Advancing by many steps at once is exact as long as the positions, speeds and timers lie on a binary grid (e.g. speeds of 4 or 5 tiles/second, as TICK is a power of two).
+Otherwise the skipped steps are added one by one, in the order the game adds them, which is still much cheaper than taking them.
+*/
+class CEventSimulation
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Sets the game up. It only reads the given gamestate, like CSimulation::play.
+    ///
+    /// @param [in] gamestate the gamestate the game starts from, with the config already loaded
+    /// @param [in] seed seed of the bot
+    /// @param [out] recording if set, the game is recorded into it, the same way CSimulation::play records it
+    CEventSimulation(const CGameState &gamestate, unsigned int seed, CReplay *recording = nullptr);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Plays the whole game.
+    ///
+    /// @return the same result as CSimulation::play with the same gamestate and seed
+    CGameResult play();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the number of steps taken one by one by CGame::step.
+    long long getTakenSteps() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the number of steps skipped over.
+    long long getSkippedSteps() const;
+
+private:
+    /** \class CEvent
+    The step in which an actor has to be looked at again.
+    */
+    struct CEvent
+    {
+        long long step;       ///< index of the step
+        size_t actor;         ///< index of the actor
+        unsigned int version; ///< the version of the actor's plan the event belongs to (its motion for a meeting), events of older ones are skipped
+
+        bool operator>(const CEvent &rhs) const { return step > rhs.step; }
+    };
+
+    /** \class CActor
+    The plan of the player or of a ghost: how it moves in every step until its next event.
+    */
+    struct CActor
+    {
+        size_t kind = 0;                          ///< personality of a ghost, its index in CGhostStore::CPersonalities
+        size_t index = 0;                         ///< index of a ghost in the arrays of its personality
+        double dx = 0;                            ///< x coordinate change in every step
+        double dy = 0;                            ///< y coordinate change in every step
+        CDirection direction = CDirection::none;  ///< the direction the actor moves in
+        CPos expected;                            ///< where a ghost should be after a step taken by CGame::step, if the step went by its plan
+        unsigned int version = 0;                 ///< incremented with every new plan
+        unsigned int motion = 0;                  ///< incremented whenever the actor leaves the straight line it moved along, older meetings of a ghost are skipped
+        long long end = 0;                        ///< index of the first step that is not part of the plan
+    };
+
+    /** \class CCell
+    What the game looks at on the axis an actor moves along. Within a cell, every position is treated the same, the steps that pass it can be skipped.
+    */
+    struct CCell
+    {
+        int tile;      ///< the coordinate truncated toward zero, as CPos::getIntPos does it
+        bool nearTile; ///< the coordinate is less than CMazeGraph::THRESHOLD right of or below the tile
+        bool farTile;  ///< the coordinate is more than CMazeGraph::THRESHOLD right of or below the tile
+        int rounded;   ///< the coordinate rounded, as the collectibles and the collisions use it
+        bool outside;  ///< the coordinate lies outside of the tunnel ends, the game moves it to the other side
+
+        bool operator==(const CCell &rhs) const = default;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Plans all actors again, e.g. after the gamemode changed the speed of the ghosts or a new level was set up.
+    void planAll();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Plans an actor again from its current state and queues its next event. If the actor leaves its straight line, its meetings are found again,
+    /// those of every ghost for the player.
+    ///
+    /// @param [in] actor index of the actor, 0 is the player
+    /// @param [in] followed true if the actor is where its previous plan took it, false e.g. for a ghost that was eaten or for a new level
+    void plan(size_t actor, bool followed);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Finds the next step in which a ghost could meet the player and queues it.
+    ///
+    /// @param [in] actor index of the ghost
+    void planMeeting(size_t actor);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Finds the meetings of all ghosts with the player again, after the player left its straight line.
+    void planMeetings();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Finds the step in which the first of the mode timers expires.
+    void planTimers();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the number of the following steps in which nothing is decided, i.e. the steps until the nearest event.
+    long long findQuietSteps();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Skips over a number of steps in which nothing is decided, the actors and the timers are advanced as the steps would advance them.
+    ///
+    /// @param [in] steps number of the steps
+    void skip(long long steps);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Takes the step of an event with CGame::step and plans the actors it affected again.
+    void take();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Counts the steps of an actor moving in a straight line until it reaches a position where it is not quiet.
+    ///
+    /// @param [in] pos the position of the actor
+    /// @param [in] dx x coordinate change in every step
+    /// @param [in] dy y coordinate change in every step, either dx or dy is 0
+    /// @param [in] limit the most steps counted
+    /// @param [in] quiet tells if nothing is decided at a position, neither when a step ends there nor when the next one starts there.
+    /// It is only asked once per cell, at the first position of the cell that is reached.
+    /// @param [in] enterable tells if nothing is decided when a step ends at a position, what happens when the next step starts there does not matter
+    /// @return the number of steps that can be skipped: all of them start at quiet positions, the last one may end at an enterable one
+    template <class TQuiet, class TEnterable>
+    long long findQuietMoves(CPos pos, double dx, double dy, long long limit, TQuiet quiet, TEnterable enterable) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Counts the steps of a value, changed by the same amount in every step, until it stops fulfilling a condition.
+    ///
+    /// @param [in] value the value
+    /// @param [in] delta the change in every step
+    /// @param [in] limit the most steps counted
+    /// @param [in] condition the condition, it has to stop being fulfilled at one point and never be fulfilled again
+    /// @return the largest number of steps, at most limit, after which the value still fulfills the condition
+    template <class TCondition>
+    static long long countSteps(double value, double delta, long long limit, TCondition condition);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the first step in which a ghost could collide with the player, if both keep on moving in their straight lines.
+    /// A ghost collides when it is on the same (rounded) tile as the player, so the steps in which they are less than a tile apart on both axes are returned.
+    ///
+    /// @param [in] ghost the ghost
+    /// @param [in] player the player
+    /// @return the step relative to the current one, -1 if they cannot collide
+    long long findMeeting(const CActor &ghost, const CActor &player) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the value after a number of steps, computed exactly as the steps would add it.
+    ///
+    /// @param [in] value the value
+    /// @param [in] delta the change in every step
+    /// @param [in] steps number of the steps
+    static double advance(double value, double delta, long long steps);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Checks if a value changed in every step can be advanced by a multiplication, i.e. if the sum of the steps is never rounded.
+    ///
+    /// @param [in] value the value
+    /// @param [in] delta the change in every step
+    /// @param [in] steps number of the steps
+    static bool isExact(double value, double delta, long long steps);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the cell of a coordinate.
+    ///
+    /// @param [in] coordinate the coordinate
+    /// @param [in] size the width of the board for x coordinates, its height for y coordinates
+    static CCell getCell(double coordinate, int size);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the position of an actor.
+    ///
+    /// @param [in] actor index of the actor, 0 is the player
+    CPos &getPos(size_t actor);
+
+    CGame game;                  ///< the game
+    CBot bot;                    ///< the player
+    CReplay *recording;          ///< if set, every step is recorded into it
+    std::vector<CActor> actors;  ///< the player followed by the ghosts, one personality after another
+    std::priority_queue<CEvent, std::vector<CEvent>, std::greater<CEvent>> events;   ///< the next event of every actor, the nearest on top
+    std::priority_queue<CEvent, std::vector<CEvent>, std::greater<CEvent>> meetings; ///< the next meeting of every ghost with the player, keyed by the motion of the ghost
+    long long step = 0;          ///< index of the next step
+    long long stepLimit = 0;     ///< number of the steps CSimulation::play takes before its time limit
+    long long timersEnd = 0;     ///< index of the step in which the first mode timer expires, or stepLimit
+    double time = 0;             ///< simulated seconds, summed up like CSimulation::play sums them
+    long long takenSteps = 0;    ///< steps taken by CGame::step
+    long long skippedSteps = 0;  ///< steps skipped over
+};
+
+template <class TQuiet, class TEnterable>
+long long CEventSimulation::findQuietMoves(CPos pos, double dx, double dy, long long limit, TQuiet quiet, TEnterable enterable) const
+{
+    if (!quiet(pos))
+        return 0;
+
+    if (dx == 0 && dy == 0)
+        return limit;
+
+    bool horizontal = dx != 0;
+    double start = horizontal ? pos.x : pos.y;
+    double delta = horizontal ? dx : dy;
+    int size = horizontal ? game.gamestate.gameMap.BOARDWIDTH : game.gamestate.gameMap.BOARDHEIGHT;
+    auto at = [&](double coordinate)
+    {
+        return horizontal ? CPos(coordinate, pos.y) : CPos(pos.x, coordinate);
+    };
+
+    CCell cell = getCell(start, size);
+
+    if (!isExact(start, delta, limit))
+    {
+        // the steps are added one by one, like the game adds them
+        double coordinate = start;
+        for (long long steps = 1; steps <= limit; steps++)
+        {
+            coordinate += delta;
+            CCell next = getCell(coordinate, size);
+            if (next == cell)
+                continue;
+
+            if (!quiet(at(coordinate)))
+                return enterable(at(coordinate)) ? steps : steps - 1;
+            cell = next;
+        }
+
+        return limit;
+    }
+
+    // a cell is shorter than a tile, so the next one is reached within a tile's worth of steps
+    long long cellSteps = static_cast<long long>(1 / std::fabs(delta)) + 2;
+    long long steps = 0;
+
+    while (steps < limit)
+    {
+        // binary search of the first step in the next cell, limit + 1 stands for a step beyond the limit
+        long long low = steps;
+        long long high = std::min(steps + cellSteps, limit + 1);
+        if (high <= limit && getCell(start + high * delta, size) == cell)
+        {
+            steps = high;
+            continue;
+        }
+
+        while (high - low > 1)
+        {
+            long long middle = low + (high - low) / 2;
+            if (getCell(start + middle * delta, size) == cell)
+                low = middle;
+            else
+                high = middle;
+        }
+
+        if (high > limit)
+            return limit;
+
+        if (!quiet(at(start + high * delta)))
+            return enterable(at(start + high * delta)) ? high : high - 1;
+
+        cell = getCell(start + high * delta, size);
+        steps = high;
+    }
+
+    return limit;
+}
+
+template <class TCondition>
+long long CEventSimulation::countSteps(double value, double delta, long long limit, TCondition condition)
+{
+    if (!isExact(value, delta, limit))
+    {
+        long long steps = 0;
+        while (steps < limit && condition(value += delta))
+            steps++;
+
+        return steps;
+    }
+
+    if (condition(value + limit * delta))
+        return limit;
+
+    // the condition holds after low steps and does not after high steps
+    long long low = 0;
+    long long high = limit;
+    while (high - low > 1)
+    {
+        long long middle = low + (high - low) / 2;
+        if (condition(value + middle * delta))
+            low = middle;
+        else
+            high = middle;
+    }
+
+    return condition(value) ? low : 0;
+}
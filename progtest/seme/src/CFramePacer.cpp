@@ -0,0 +1,54 @@
+#include "CFramePacer.h"
+
+#include <thread>
+
+CFramePacer::CFramePacer(CMode mode, double fps)
+    : mode(mode),
+      frameTime(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1 / (fps > 0 ? fps : DEFAULT_FPS))))
+{
+}
+
+void CFramePacer::wait()
+{
+    if (mode != CMode::capped)
+        return;
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (!started || now > deadline + frameTime) // a frame was missed by a whole frame, the schedule starts over instead of rushing the following ones
+    {
+        deadline = now + frameTime;
+        started = true;
+    }
+    else
+        deadline += frameTime;
+
+    if (deadline - now > SPIN_TIME)
+        std::this_thread::sleep_until(deadline - SPIN_TIME);
+
+    while (std::chrono::steady_clock::now() < deadline)
+        std::this_thread::yield();
+}
+
+void CFramePacer::reset()
+{
+    started = false;
+}
+
+CFramePacer::CMode CFramePacer::getMode() const
+{
+    return mode;
+}
+
+bool CFramePacer::parseMode(const std::string &name, CMode &mode)
+{
+    if (name == "vsync")
+        mode = CMode::vsync;
+    else if (name == "cap")
+        mode = CMode::capped;
+    else if (name == "uncapped")
+        mode = CMode::uncapped;
+    else
+        return false;
+
+    return true;
+}
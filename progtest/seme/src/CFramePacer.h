@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+/** \class CFramePacer
+Limits how often frames are drawn.
+
+With vsync, SDL_RenderPresent waits for the display and the pacer does nothing. When capped, the pacer sleeps until the deadline of the next frame
+and spins for the last part of the wait, because the operating system wakes sleeping threads up late. Uncapped frames are drawn as fast as possible, for benchmarks.
+*/
+class CFramePacer
+{
+public:
+    /** \class CMode
+    The pacing modes.
+    */
+    enum class CMode
+    {
+        vsync,   ///< waits for the display in SDL_RenderPresent
+        capped,  ///< sleeps until the deadline of the next frame
+        uncapped ///< does not wait at all
+    };
+
+    static constexpr double DEFAULT_FPS = 60; ///< frames per second of the capped mode, if not given
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Constructor that sets the mode.
+    ///
+    /// @param [in] mode the pacing mode
+    /// @param [in] fps frames per second, used by the capped mode
+    CFramePacer(CMode mode = CMode::vsync, double fps = DEFAULT_FPS);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Called at the end of every frame. In the capped mode it waits until the next frame is due.
+    void wait();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Forgets the previous deadline. Called after the game loop was blocked, so that the following frames are not rushed to catch up.
+    void reset();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the pacing mode.
+    CMode getMode() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Reads a pacing mode from its name: "vsync", "cap" or "uncapped".
+    ///
+    /// @param [in] name the name
+    /// @param [out] mode the mode
+    /// @return false if the name is unknown
+    static bool parseMode(const std::string &name, CMode &mode);
+
+private:
+    static constexpr std::chrono::microseconds SPIN_TIME{1000}; ///< the last part of the wait that is spent spinning instead of sleeping
+
+    CMode mode;                                       ///< the pacing mode
+    std::chrono::steady_clock::duration frameTime;    ///< time between two frames in the capped mode
+    std::chrono::steady_clock::time_point deadline{}; ///< when the next frame is due
+    bool started = false;                             ///< false until the first deadline is set
+};
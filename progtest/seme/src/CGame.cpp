@@ -0,0 +1,233 @@
+#include "CGame.h"
+
+#include <cstdint>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+void CGame::takeSnapshot()
+{
+    const CGameMap &gameMap = gamestate.gameMap;
+    const CMapEntity *entities = gameMap.getEntities();
+    snapshot.ghosts.clear();
+    snapshot.collectibles.reset(gameMap.BOARDWIDTH, gameMap.BOARDHEIGHT);
+    snapshot.playerPos = CPos(0, 0);
+    snapshot.coinCount = 0;
+
+    // the map lists its entities when it is compiled, so the empty tiles and walls are not visited again
+    for (size_t i = 0; i < gameMap.getEntityCount(); i++)
+    {
+        const CMapEntity &entity = entities[i];
+
+        switch (entity.object)
+        {
+        case (CGameMap::CMapObjects::C):
+            snapshot.coinCount++;
+            snapshot.collectibles.add(CCollectible::CKind::coin, entity.x, entity.y);
+            break;
+        case (CGameMap::CMapObjects::P):
+            snapshot.collectibles.add(CCollectible::CKind::powerUp, entity.x, entity.y);
+            break;
+        case (CGameMap::CMapObjects::S):
+            snapshot.playerPos = CPos(entity.x, entity.y);
+            break;
+        default:
+        {
+            // every other object is the start position of a ghost, the registry knows of which personality
+            int kind = CGhostStore::findKind(static_cast<CGameMap::CMapObjects>(entity.object));
+            if (kind >= 0)
+                spawnGhosts(kind, entity.x, entity.y);
+            break;
+        }
+        }
+    }
+
+    snapshot.taken = true;
+}
+
+void CGame::spawnGhosts(size_t kind, int x, int y)
+{
+    const CGameMap &gameMap = gamestate.gameMap;
+    size_t count = gamestate.SPAWN_COUNT;
+    std::vector<std::pair<int, int>> tiles = {{x, y}};
+    std::vector<std::pair<int, int>> reached = {{x, y}};
+    std::unordered_set<uint64_t> visited = {static_cast<uint64_t>(x) << 32 | static_cast<uint32_t>(y)};
+
+    // the tiles are taken in the order a breadth-first search reaches them, so the ghosts fill the maze outward from the start tile.
+    // The search passes the player's start, but no ghost is placed there
+    for (size_t i = 0; i < reached.size() && tiles.size() < count; i++)
+    {
+        const std::pair<int, int> neighbours[4] = {{reached[i].first, reached[i].second - 1}, {reached[i].first, reached[i].second + 1},
+                                                   {reached[i].first - 1, reached[i].second}, {reached[i].first + 1, reached[i].second}};
+
+        for (const std::pair<int, int> &tile : neighbours)
+        {
+            CGameMap::CMapObjects object = gameMap.getTile(tile.first, tile.second);
+            if (object == CGameMap::CMapObjects::W || !visited.insert(static_cast<uint64_t>(tile.first) << 32 | static_cast<uint32_t>(tile.second)).second)
+                continue;
+
+            reached.push_back(tile);
+            if (object != CGameMap::CMapObjects::S && tiles.size() < count)
+                tiles.push_back(tile);
+        }
+    }
+
+    // more ghosts than reachable tiles take the tiles again from the start
+    for (size_t ghost = 0; ghost < count; ghost++)
+        snapshot.ghosts.add(kind, CPos(tiles[ghost % tiles.size()].first, tiles[ghost % tiles.size()].second));
+}
+
+void CGame::setup()
+{
+    if (!gamestate.distanceTable)
+        gamestate.distanceTable = CDistanceTable::load(gamestate.gameMap, "build");
+
+    if (!snapshot.taken)
+        takeSnapshot();
+
+    ghosts = snapshot.ghosts; // the vectors keep their capacity, so this is a plain copy
+    collectibles.restore(snapshot.collectibles);
+    gamestate.playerPos = snapshot.playerPos;
+    gamestate.gameMap.coinCount = snapshot.coinCount;
+
+    gamestate.previousPlayerPos = gamestate.playerPos;
+    gamestate.nextMove = CDirection::none;
+    gamestate.thisMove = CDirection::none;
+    gamestate.nextGuard = gamestate.TIME_BETWEEN_GUARD_MODE;
+    gamestate.guardTimeRemaining = 0;
+    gamestate.gamemode = CGameState::CGameMode::chase;
+}
+
+void CGame::restart()
+{
+    gamestate.score = 0;
+    gamestate.level = 1;
+    gamestate.scorePending = false;
+    gamestate.powerUpRemaining = 0;
+    gamestate.scaleTimers();
+    setup();
+
+    if (recorder)
+        recorder->begin(gamestate);
+}
+
+void CGame::increaseLevel()
+{
+    gamestate.level++;
+    gamestate.scaleTimers();
+    setup();
+}
+
+void CGame::updatePowerUp(double deltaTime)
+{
+    if (gamestate.powerUpRemaining > 0)
+    {
+        gamestate.powerUpRemaining -= deltaTime;
+
+        if (gamestate.powerUpRemaining <= 0)
+            gamestate.gamemode = CGameState::CGameMode::chase;
+    }
+}
+
+void CGame::updateGuard(double deltaTime)
+{
+    if (gamestate.guardTimeRemaining > 0)
+    {
+        gamestate.guardTimeRemaining -= deltaTime;
+
+        if (gamestate.guardTimeRemaining <= 0)
+            gamestate.gamemode = CGameState::CGameMode::chase;
+    }
+
+    if (gamestate.nextGuard < 0 && gamestate.gamemode != CGameState::CGameMode::powerup) // ghosts will not enter guard mode while a power up is active
+    {
+        gamestate.gamemode = CGameState::CGameMode::guard;
+        gamestate.guardTimeRemaining = gamestate.guardTime;
+        gamestate.nextGuard = gamestate.TIME_BETWEEN_GUARD_MODE;
+    }
+}
+
+void CGame::updateGameModes(double deltaTime)
+{
+    updatePowerUp(deltaTime);
+    updateGuard(deltaTime);
+}
+
+void CGame::updateGameObjects(double deltaTime)
+{
+    ghosts.update(gamestate, deltaTime);
+}
+
+void CGame::updatePlaying(double deltaTime)
+{
+    gamestate.nextGuard -= deltaTime;
+
+    {
+        CProfiler::CScope scope(profiler, CProfiler::playerMovement);
+
+        if (gamestate.isThisMoveLegal())
+            gamestate.updatePos(deltaTime);
+
+        if (gamestate.isNextMoveLegal())
+            gamestate.updateMoves();
+    }
+    {
+        CProfiler::CScope scope(profiler, CProfiler::gameModes);
+        updateGameModes(deltaTime);
+    }
+    {
+        CProfiler::CScope scope(profiler, CProfiler::collectibles);
+        collectibles.update(gamestate);
+    }
+    {
+        CProfiler::CScope scope(profiler, CProfiler::ghosts);
+        updateGameObjects(deltaTime);
+    }
+}
+
+void CGame::update(double deltaTime)
+{
+    if (gamestate.gameMap.coinCount == 0)
+    {
+        increaseLevel();
+    }
+
+    if (gamestate.screen == CGameState::CScreen::playing)
+    {
+        updatePlaying(deltaTime);
+    }
+}
+
+void CGame::step()
+{
+    if (recorder)
+        recorder->record(gamestate);
+
+    gamestate.previousPlayerPos = gamestate.playerPos;
+    update(TICK);
+}
+
+void CGame::saveState(CGameSnapshot &snapshot) const
+{
+    snapshot.clear();
+    gamestate.saveState(snapshot);
+    ghosts.saveState(snapshot);
+    collectibles.saveState(snapshot);
+}
+
+bool CGame::restoreState(const CGameSnapshot &snapshot)
+{
+    size_t offset = 0;
+
+    if (!gamestate.restoreState(snapshot, offset) ||
+        !ghosts.restoreState(snapshot, offset) ||
+        !collectibles.restoreState(snapshot, offset) ||
+        offset != snapshot.size())
+        return false;
+
+    // the recorded moves would not lead to the restored state
+    if (recorder)
+        recorder->discard();
+
+    return true;
+}
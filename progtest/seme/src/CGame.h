@@ -0,0 +1,125 @@
+#pragma once
+
+#include "CGameState.h"
+#include "CGhostStore.h"
+#include "CCollectibleGrid.h"
+#include "CProfiler.h"
+#include "CGameSnapshot.h"
+#include "CReplay.h"
+
+/** \class CLevelSnapshot
+The state of a level right after it was loaded from the map. It is built once, every start of a level is then a copy of it.
+*/
+struct CLevelSnapshot
+{
+    CGhostStore ghosts;            ///< the ghosts at their start positions
+    CCollectibleGrid collectibles; ///< all coins and power ups, none collected
+    CPos playerPos;                ///< the start position of the player
+    int coinCount = 0;             ///< number of coins of the level
+    bool taken = false;            ///< true if the snapshot was built from the current map
+};
+
+/** \class CGame
+The simulation core. Holds the gamestate together with the ghosts and the collectibles and advances them in time.
+
+It does not depend on SDL, so it can be linked into the windowed game as well as into headless tools.
+*/
+class CGame
+{
+public:
+    static constexpr double TICK = 1 / 128.0; ///< Seconds. Simulated time of a single step. A power of two, so that positions and timers stay exact in floating point. At up to 6 tiles/second, no tile center is skipped between two steps.
+
+    CGameState gamestate;          ///< the gamestate of this game
+    CGhostStore ghosts;            ///< all ghosts, grouped by personality
+    CCollectibleGrid collectibles; ///< coins and power ups, indexed by tile
+    CProfiler *profiler = nullptr; ///< if set, the phases of every step are measured by it
+    CReplay *recorder = nullptr;   ///< if set, the move of every step is recorded into it. A restart begins a new recording, restoring a snapshot discards it.
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Initializes game objects and other gamestate variables. Called once before the game loop starts and then on every level increase.
+    ///
+    /// The first call builds the snapshot of the level from the map, the next ones only copy it. Once the ghosts and the collectibles
+    /// have grown to the size of the level, the copy reuses their memory, so starting a level allocates nothing and does not visit the map.
+    void setup();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Starts a new game from the first level. Called when the player wants to play again.
+    ///
+    /// @note Nothing is left over from the previous game, so that the new one plays the same as a game set up from scratch (e.g. by a replay).
+    void restart();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Advances the game by a single fixed step of TICK seconds. The result does not depend on how fast the steps are taken.
+    void step();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Saves everything that changes while the game is played into a snapshot. The level itself is not saved, a snapshot can only be restored into a game
+    /// set up from the same map. The snapshot keeps its memory between saves, so saving a game of the same size again allocates nothing.
+    ///
+    /// @param [out] snapshot the snapshot, its previous content is replaced
+    void saveState(CGameSnapshot &snapshot) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Continues the game from a snapshot saved by saveState. Used for rewinding and for loading a saved game.
+    ///
+    /// @note If the snapshot is broken, the game may be left partly restored. Restore into a copy of the game when the snapshot comes from outside.
+    ///
+    /// @param [in] snapshot the snapshot
+    /// @return false if the snapshot is broken or was saved on a different map
+    bool restoreState(const CGameSnapshot &snapshot);
+
+private:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Calls increaseLevel if necessary and updatePlaying if the active screen is "playing".
+    ///
+    /// @param [in] deltaTime time change since last update, used for time keeping
+    void update(double deltaTime);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Builds the snapshot of the level from the entities of the game board stored in the gamestate instance.
+    void takeSnapshot();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Adds the ghosts of a start tile to the snapshot: SPAWN_COUNT of them, the first one on the start tile, the others on the walkable tiles nearest to it.
+    ///
+    /// @param [in] kind the personality of the ghosts, its index in CGhostStore::CPersonalities
+    /// @param [in] x x coordinate of the start tile
+    /// @param [in] y y coordinate of the start tile
+    void spawnGhosts(size_t kind, int x, int y);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Called when the player reaches the next level. It increases difficulty by scaling power up and guard times to the new level and starts the level from the snapshot.
+    void increaseLevel();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Called every frame to check if the ghosts should enter or exit power up mode
+    ///
+    /// @param [in] deltaTime time change since last frame, used for time keeping
+    void updatePowerUp(double deltaTime);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Called every frame to check if the ghosts should enter or exit guard mode
+    ///
+    /// @param [in] deltaTime time change since last frame, used for time keeping
+    void updateGuard(double deltaTime);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// A wrapper method that calls the individual methods taking care of gamemodes (updateGuard and updatePowerUp)
+    ///
+    /// @param [in] deltaTime time change since last frame, used for time keeping
+    void updateGameModes(double deltaTime);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// A wrapper method that updates the ghosts, one personality at a time.
+    ///
+    /// @param [in] deltaTime time change since last frame, used for time keeping
+    void updateGameObjects(double deltaTime);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// A wrapper method that updates the player position and calls other update methods. Called if the active screen is playing.
+    ///
+    /// @param [in] deltaTime time change since last frame, used for time keeping
+    void updatePlaying(double deltaTime);
+
+    CLevelSnapshot snapshot; ///< the initial state of the level, copied on every start of a level
+};
@@ -0,0 +1,127 @@
+#include "CGameMap.h"
+
+const CGameMap::CMapObjects CGameMap::DEFAULT_BOARD[31][28] = {
+    {W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W},
+    {W, C, C, C, C, C, C, C, C, C, C, C, C, W, W, C, C, C, C, C, C, C, C, C, C, C, C, W},
+    {W, C, W, W, W, W, C, W, W, W, W, W, C, W, W, C, W, W, W, W, W, C, W, W, W, W, C, W},
+    {W, P, W, W, W, W, C, W, W, W, W, W, C, W, W, C, W, W, W, W, W, C, W, W, W, W, P, W},
+    {W, C, W, W, W, W, C, W, W, W, W, W, C, W, W, C, W, W, W, W, W, C, W, W, W, W, C, W},
+    {W, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, W},
+    {W, C, W, W, W, W, C, W, W, C, W, W, W, W, W, W, W, W, C, W, W, C, W, W, W, W, C, W},
+    {W, C, W, W, W, W, C, W, W, C, W, W, W, W, W, W, W, W, C, W, W, C, W, W, W, W, C, W},
+    {W, C, C, C, C, C, C, W, W, C, C, C, C, W, W, C, C, C, C, W, W, C, C, C, C, C, C, W},
+    {W, W, W, W, W, W, C, W, W, W, W, W, O, W, W, O, W, W, W, W, W, C, W, W, W, W, W, W},
+    {W, W, W, W, W, W, C, W, W, W, W, W, O, W, W, O, W, W, W, W, W, C, W, W, W, W, W, W},
+    {W, W, W, W, W, W, C, W, W, O, O, O, O, O, O, O, O, O, O, W, W, C, W, W, W, W, W, W},
+    {W, W, W, W, W, W, C, W, W, O, W, W, W, O, O, W, W, W, O, W, W, C, W, W, W, W, W, W},
+    {W, W, W, W, W, W, C, W, W, O, W, O, O, O, O, O, O, W, O, W, W, C, W, W, W, W, W, W},
+    {O, O, O, O, O, O, C, O, O, O, O, O, m, t, e, O, O, O, O, O, O, C, O, O, O, O, O, O},
+    {W, W, W, W, W, W, C, W, W, O, W, O, O, O, O, O, O, W, O, W, W, C, W, W, W, W, W, W},
+    {W, W, W, W, W, W, C, W, W, O, W, W, W, O, O, W, W, W, O, W, W, C, W, W, W, W, W, W},
+    {W, W, W, W, W, W, C, W, W, O, O, O, O, O, O, O, O, O, O, W, W, C, W, W, W, W, W, W},
+    {W, W, W, W, W, W, C, W, W, O, W, W, W, W, W, W, W, W, O, W, W, C, W, W, W, W, W, W},
+    {W, W, W, W, W, W, C, W, W, O, W, W, W, W, W, W, W, W, O, W, W, C, W, W, W, W, W, W},
+    {W, C, C, C, C, C, C, C, C, C, C, C, C, W, W, C, C, C, C, C, C, C, C, C, C, C, C, W},
+    {W, C, W, W, W, W, C, W, W, W, W, W, C, W, W, C, W, W, W, W, W, C, W, W, W, W, C, W},
+    {W, C, W, W, W, W, C, W, W, W, W, W, C, W, W, C, W, W, W, W, W, C, W, W, W, W, C, W},
+    {W, P, C, C, W, W, C, C, C, C, C, C, C, S, O, C, C, C, C, C, C, C, W, W, C, C, P, W},
+    {W, W, W, C, W, W, C, W, W, C, W, W, W, W, W, W, W, W, C, W, W, C, W, W, C, W, W, W},
+    {W, W, W, C, W, W, C, W, W, C, W, W, W, W, W, W, W, W, C, W, W, C, W, W, C, W, W, W},
+    {W, C, C, C, C, C, C, W, W, C, C, C, C, W, W, C, C, C, C, W, W, C, C, C, C, C, C, W},
+    {W, C, W, W, W, W, W, W, W, W, W, W, C, W, W, C, W, W, W, W, W, W, W, W, W, W, C, W},
+    {W, C, W, W, W, W, W, W, W, W, W, W, C, W, W, C, W, W, W, W, W, W, W, W, W, W, C, W},
+    {W, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, W},
+    {W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W},
+};
+
+CGameMap::CGameMap()
+{
+    clear();
+
+    for (int i = 0; i < BOARDHEIGHT; i++)
+        for (int j = 0; j < BOARDWIDTH; j++)
+            setTile(j, i, DEFAULT_BOARD[i][j]);
+
+    compile();
+}
+
+void CGameMap::clear()
+{
+    chunkColumns = (BOARDWIDTH + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    int chunkRows = (BOARDHEIGHT + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    chunks.clear();
+    chunks.resize(chunkColumns * chunkRows);
+    entities.clear();
+    mappedTiles = nullptr;
+    mappedEntities = nullptr;
+    mappedEntityCount = 0;
+}
+
+void CGameMap::attach(const uint8_t *tiles, const CMapEntity *entities, size_t entityCount, const uint8_t *exits)
+{
+    clear();
+    chunks.clear(); // nothing is allocated for an attached board
+
+    mappedTiles = tiles;
+    mappedEntities = entities;
+    mappedEntityCount = entityCount;
+    graph.attach(exits, BOARDWIDTH, BOARDHEIGHT);
+}
+
+CGameMap::CMapObjects CGameMap::getTile(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= BOARDWIDTH || y >= BOARDHEIGHT)
+        return W;
+
+    if (mappedTiles)
+        return static_cast<CMapObjects>(mappedTiles[y * BOARDWIDTH + x]);
+
+    const std::vector<uint8_t> &chunk = chunks[(y / CHUNK_SIZE) * chunkColumns + x / CHUNK_SIZE];
+    if (chunk.empty())
+        return W;
+
+    return static_cast<CMapObjects>(chunk[(y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE]);
+}
+
+void CGameMap::setTile(int x, int y, CMapObjects object)
+{
+    if (x < 0 || y < 0 || x >= BOARDWIDTH || y >= BOARDHEIGHT || mappedTiles)
+        return;
+
+    std::vector<uint8_t> &chunk = chunks[(y / CHUNK_SIZE) * chunkColumns + x / CHUNK_SIZE];
+    if (chunk.empty())
+    {
+        if (object == W) // walls are what a missing chunk holds anyway
+            return;
+
+        chunk.assign(CHUNK_SIZE * CHUNK_SIZE, W);
+    }
+
+    chunk[(y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE] = object;
+}
+
+void CGameMap::compile()
+{
+    entities.clear();
+
+    for (int i = 0; i < BOARDHEIGHT; i++)
+        for (int j = 0; j < BOARDWIDTH; j++)
+        {
+            CMapObjects object = getTile(j, i);
+            if (object != W && object != O)
+                entities.push_back({j, i, static_cast<uint32_t>(object)});
+        }
+
+    graph.build(*this);
+}
+
+const CMapEntity *CGameMap::getEntities() const
+{
+    return mappedTiles ? mappedEntities : entities.data();
+}
+
+size_t CGameMap::getEntityCount() const
+{
+    return mappedTiles ? mappedEntityCount : entities.size();
+}
@@ -1,15 +1,32 @@
 #pragma once
-constexpr int MAXWIDTH = 100;
+#include "CMazeGraph.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** \class CMapEntity
+A tile holding a collectible or a start position. The layout is fixed, entities are stored this way in compiled level files.
+*/
+struct CMapEntity
+{
+    int32_t x;       ///< x coordinate of the tile
+    int32_t y;       ///< y coordinate of the tile
+    uint32_t object; ///< the CGameMap::CMapObjects value of the tile
+};
 
 /** \class CGameMap
-A 2-d array and a set of constants to represent the game board.
+The game board and a set of constants describing it.
+
+The tiles are stored in square chunks, a chunk is only allocated once a tile that is not a wall is placed in it.
+Regions made only of walls, e.g. around the maze of a huge map, take no memory.
+
+A board loaded from a compiled level file is not copied, its tiles, entities and exit masks are read where the file is mapped.
 */
 struct CGameMap
 {
-
-    int BOARDHEIGHT = 31; ///< configuration constant loaded from a config file. If no config file is present, or the loading fails, the default is used.
-    int BOARDWIDTH = 28;  ///< configuration constant loaded from a config file. If no config file is present, or the loading fails, the default is used.
-    int coinCount = 240;  ///< configuration constant loaded from a config file. If no config file is present, or the loading fails, the default is used.
+    static constexpr int MAX_SIZE = 4096; ///< the largest supported board width and height
+    static constexpr int CHUNK_SIZE = 32; ///< width and height of a chunk, in tiles
 
     enum CMapObjects
     {
@@ -22,37 +39,66 @@ struct CGameMap
         e, ///< Euclides start pos
         O  ///< empty
     };
-    short unsigned int map[MAXWIDTH][MAXWIDTH] = {
-        {W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W},
-        {W, C, C, C, C, C, C, C, C, C, C, C, C, W, W, C, C, C, C, C, C, C, C, C, C, C, C, W},
-        {W, C, W, W, W, W, C, W, W, W, W, W, C, W, W, C, W, W, W, W, W, C, W, W, W, W, C, W},
-        {W, P, W, W, W, W, C, W, W, W, W, W, C, W, W, C, W, W, W, W, W, C, W, W, W, W, P, W},
-        {W, C, W, W, W, W, C, W, W, W, W, W, C, W, W, C, W, W, W, W, W, C, W, W, W, W, C, W},
-        {W, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, W},
-        {W, C, W, W, W, W, C, W, W, C, W, W, W, W, W, W, W, W, C, W, W, C, W, W, W, W, C, W},
-        {W, C, W, W, W, W, C, W, W, C, W, W, W, W, W, W, W, W, C, W, W, C, W, W, W, W, C, W},
-        {W, C, C, C, C, C, C, W, W, C, C, C, C, W, W, C, C, C, C, W, W, C, C, C, C, C, C, W},
-        {W, W, W, W, W, W, C, W, W, W, W, W, O, W, W, O, W, W, W, W, W, C, W, W, W, W, W, W},
-        {W, W, W, W, W, W, C, W, W, W, W, W, O, W, W, O, W, W, W, W, W, C, W, W, W, W, W, W},
-        {W, W, W, W, W, W, C, W, W, O, O, O, O, O, O, O, O, O, O, W, W, C, W, W, W, W, W, W},
-        {W, W, W, W, W, W, C, W, W, O, W, W, W, O, O, W, W, W, O, W, W, C, W, W, W, W, W, W},
-        {W, W, W, W, W, W, C, W, W, O, W, O, O, O, O, O, O, W, O, W, W, C, W, W, W, W, W, W},
-        {O, O, O, O, O, O, C, O, O, O, O, O, m, t, e, O, O, O, O, O, O, C, O, O, O, O, O, O},
-        {W, W, W, W, W, W, C, W, W, O, W, O, O, O, O, O, O, W, O, W, W, C, W, W, W, W, W, W},
-        {W, W, W, W, W, W, C, W, W, O, W, W, W, O, O, W, W, W, O, W, W, C, W, W, W, W, W, W},
-        {W, W, W, W, W, W, C, W, W, O, O, O, O, O, O, O, O, O, O, W, W, C, W, W, W, W, W, W},
-        {W, W, W, W, W, W, C, W, W, O, W, W, W, W, W, W, W, W, O, W, W, C, W, W, W, W, W, W},
-        {W, W, W, W, W, W, C, W, W, O, W, W, W, W, W, W, W, W, O, W, W, C, W, W, W, W, W, W},
-        {W, C, C, C, C, C, C, C, C, C, C, C, C, W, W, C, C, C, C, C, C, C, C, C, C, C, C, W},
-        {W, C, W, W, W, W, C, W, W, W, W, W, C, W, W, C, W, W, W, W, W, C, W, W, W, W, C, W},
-        {W, C, W, W, W, W, C, W, W, W, W, W, C, W, W, C, W, W, W, W, W, C, W, W, W, W, C, W},
-        {W, P, C, C, W, W, C, C, C, C, C, C, C, S, O, C, C, C, C, C, C, C, W, W, C, C, P, W},
-        {W, W, W, C, W, W, C, W, W, C, W, W, W, W, W, W, W, W, C, W, W, C, W, W, C, W, W, W},
-        {W, W, W, C, W, W, C, W, W, C, W, W, W, W, W, W, W, W, C, W, W, C, W, W, C, W, W, W},
-        {W, C, C, C, C, C, C, W, W, C, C, C, C, W, W, C, C, C, C, W, W, C, C, C, C, C, C, W},
-        {W, C, W, W, W, W, W, W, W, W, W, W, C, W, W, C, W, W, W, W, W, W, W, W, W, W, C, W},
-        {W, C, W, W, W, W, W, W, W, W, W, W, C, W, W, C, W, W, W, W, W, W, W, W, W, W, C, W},
-        {W, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, C, W},
-        {W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W},
-    }; ///< configuration constant loaded from a config file. If no config file is present, or the loading fails, the default is used. A 2-d array with enum constants is used to represent the game board.
-};
\ No newline at end of file
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Loads the default board and compiles it.
+    CGameMap();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Turns every tile into a wall and frees the chunks. The board keeps its size. Detaches a mapped level.
+    void clear();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Uses a board that was compiled in advance, in place. The board size has to be set already.
+    ///
+    /// @note The data is not copied, it has to outlive the map and all of its copies.
+    ///
+    /// @param [in] tiles BOARDWIDTH * BOARDHEIGHT tiles, row by row
+    /// @param [in] entities the entities of the board, row by row
+    /// @param [in] entityCount number of the entities
+    /// @param [in] exits the table of the maze graph, see CMazeGraph::getTable
+    void attach(const uint8_t *tiles, const CMapEntity *entities, size_t entityCount, const uint8_t *exits);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the object on a tile. Tiles outside of the board are walls.
+    ///
+    /// @param [in] x x coordinate of the tile
+    /// @param [in] y y coordinate of the tile
+    CMapObjects getTile(int x, int y) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Places an object on a tile of the board, allocating its chunk if needed. Has no effect on an attached board.
+    ///
+    /// @param [in] x x coordinate of the tile
+    /// @param [in] y y coordinate of the tile
+    /// @param [in] object the object
+    void setTile(int x, int y, CMapObjects object);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Compiles the tiles into the maze graph and the list of entities. Has to be called whenever the tiles or the board size change.
+    void compile();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the entities of the board, row by row.
+    const CMapEntity *getEntities() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the number of the entities of the board.
+    size_t getEntityCount() const;
+
+    int BOARDHEIGHT = 31; ///< configuration constant loaded from a config file. If no config file is present, or the loading fails, the default is used.
+    int BOARDWIDTH = 28;  ///< configuration constant loaded from a config file. If no config file is present, or the loading fails, the default is used.
+    int coinCount = 240;  ///< configuration constant loaded from a config file. If no config file is present, or the loading fails, the default is used.
+
+    CMazeGraph graph; ///< the exits of every tile and the corridors between the nodes, used by the movement checks of the player and the ghosts
+
+private:
+    static const CMapObjects DEFAULT_BOARD[31][28]; ///< the board used when no config file is loaded
+
+    std::vector<std::vector<uint8_t>> chunks;   ///< the chunks row by row, CHUNK_SIZE * CHUNK_SIZE tiles each. Empty if all of its tiles are walls.
+    int chunkColumns = 0;                       ///< number of chunks in a row of chunks
+    std::vector<CMapEntity> entities;           ///< the entities found by compile
+    const uint8_t *mappedTiles = nullptr;       ///< the tiles of an attached board, null if the chunks are used
+    const CMapEntity *mappedEntities = nullptr; ///< the entities of an attached board
+    size_t mappedEntityCount = 0;               ///< number of the entities of an attached board
+};
@@ -0,0 +1,90 @@
+#include "CGameSnapshot.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+constexpr char SAVE_MAGIC[4] = {'P', 'M', 'S', 'V'}; // file signature of saved games
+constexpr uint32_t SAVE_VERSION = 1;                 // bumped whenever the layout of a snapshot changes
+
+void CGameSnapshot::clear()
+{
+    data.clear();
+}
+
+void CGameSnapshot::reserve(size_t bytes)
+{
+    data.reserve(bytes);
+}
+
+size_t CGameSnapshot::size() const
+{
+    return data.size();
+}
+
+bool CGameSnapshot::writeFile(const std::string &path, uint64_t mapHash) const
+{
+    // written to a temporary file first, so that an interrupted save does not destroy the previous one
+    std::string temporaryPath = path + ".tmp";
+    std::ofstream file(temporaryPath, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    uint64_t size = data.size();
+
+    file.write(SAVE_MAGIC, sizeof(SAVE_MAGIC));
+    file.write(reinterpret_cast<const char *>(&SAVE_VERSION), sizeof(SAVE_VERSION));
+    file.write(reinterpret_cast<const char *>(&mapHash), sizeof(mapHash));
+    file.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    file.write(reinterpret_cast<const char *>(data.data()), data.size());
+    file.close();
+
+    if (!file || std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool CGameSnapshot::readFile(const std::string &path, uint64_t mapHash)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t fileHash = 0;
+    uint64_t size = 0;
+
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char *>(&version), sizeof(version));
+    file.read(reinterpret_cast<char *>(&fileHash), sizeof(fileHash));
+    file.read(reinterpret_cast<char *>(&size), sizeof(size));
+
+    if (!file ||
+        !std::equal(magic, magic + 4, SAVE_MAGIC) ||
+        version != SAVE_VERSION ||
+        fileHash != mapHash)
+        return false;
+
+    // the size is checked against the file, so that a broken size does not allocate gigabytes
+    std::streampos start = file.tellg();
+    file.seekg(0, std::ios::end);
+    if (!file || static_cast<uint64_t>(file.tellg() - start) != size)
+        return false;
+    file.seekg(start);
+
+    data.resize(size);
+    file.read(reinterpret_cast<char *>(data.data()), size);
+
+    if (!file)
+    {
+        data.clear();
+        return false;
+    }
+
+    return true;
+}
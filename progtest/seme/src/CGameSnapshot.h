@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/** \class CGameSnapshot
+The complete state of a running game as a compact block of bytes, written by CGame::saveState and read back by CGame::restoreState.
+
+Values are copied byte by byte in a fixed order, nothing is encoded. Clearing a snapshot keeps its memory, so a snapshot that is written over and over
+(e.g. by the rewind buffer) stops allocating once it has grown to the size of the game.
+*/
+class CGameSnapshot
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Removes all bytes, the memory is kept.
+    void clear();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Allocates memory for a number of bytes up front, so that writing up to that many bytes does not allocate.
+    ///
+    /// @param [in] bytes the number of bytes
+    void reserve(size_t bytes);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the number of bytes of the snapshot.
+    size_t size() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Appends a value.
+    ///
+    /// @param [in] value the value, it has to be trivially copyable
+    template <class T>
+    void write(const T &value);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Appends the number of elements of a vector followed by the elements.
+    ///
+    /// @param [in] values the vector, its elements have to be trivially copyable
+    template <class T>
+    void writeArray(const std::vector<T> &values);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Reads a value.
+    ///
+    /// @param [in, out] offset where the value starts, moved past it
+    /// @param [out] value the value
+    /// @return false if the snapshot ends before the value does
+    template <class T>
+    bool read(size_t &offset, T &value) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Reads a vector written by writeArray. The vector's memory is reused if it is large enough.
+    ///
+    /// @param [in, out] offset where the vector starts, moved past it
+    /// @param [out] values the vector
+    /// @return false if the snapshot ends before the vector does
+    template <class T>
+    bool readArray(size_t &offset, std::vector<T> &values) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Saves the snapshot to a file, together with a hash of the map it belongs to.
+    ///
+    /// @param [in] path path to the file
+    /// @param [in] mapHash hash of the map, see CDistanceTable::hashMap
+    /// @return true if the file was written
+    bool writeFile(const std::string &path, uint64_t mapHash) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Loads a snapshot saved by writeFile.
+    ///
+    /// @param [in] path path to the file
+    /// @param [in] mapHash hash of the map the game is played on, the file has to belong to the same one
+    /// @return true if the file was read, false if it is missing, broken, of another version or belongs to another map
+    bool readFile(const std::string &path, uint64_t mapHash);
+
+private:
+    std::vector<uint8_t> data; ///< the bytes of the snapshot
+};
+
+template <class T>
+void CGameSnapshot::write(const T &value)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "only plain values are copied into a snapshot");
+
+    size_t offset = data.size();
+    data.resize(offset + sizeof(T));
+    std::memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+template <class T>
+void CGameSnapshot::writeArray(const std::vector<T> &values)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "only plain values are copied into a snapshot");
+
+    uint64_t count = values.size();
+    write(count);
+
+    size_t offset = data.size();
+    data.resize(offset + count * sizeof(T));
+    if (count > 0)
+        std::memcpy(data.data() + offset, values.data(), count * sizeof(T));
+}
+
+template <class T>
+bool CGameSnapshot::read(size_t &offset, T &value) const
+{
+    static_assert(std::is_trivially_copyable_v<T>, "only plain values are copied from a snapshot");
+
+    if (offset > data.size() || data.size() - offset < sizeof(T))
+        return false;
+
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+template <class T>
+bool CGameSnapshot::readArray(size_t &offset, std::vector<T> &values) const
+{
+    static_assert(std::is_trivially_copyable_v<T>, "only plain values are copied from a snapshot");
+
+    uint64_t count = 0;
+    if (!read(offset, count) || count > (data.size() - offset) / sizeof(T))
+        return false;
+
+    values.resize(count);
+    if (count > 0)
+        std::memcpy(values.data(), data.data() + offset, count * sizeof(T));
+    offset += count * sizeof(T);
+    return true;
+}
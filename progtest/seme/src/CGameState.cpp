@@ -1,10 +1,15 @@
 #include "CGameState.h"
+#include "CLevelFile.h"
+#include "CGameSnapshot.h"
+#include "CGhostStore.h"
 
 #include <cmath>
 #include <algorithm>
 #include <vector>
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 
 void CGameState::loadSpeed(std::ifstream &config)
 {
@@ -69,6 +74,23 @@ void CGameState::loadGuardTimeDecrement(std::ifstream &config)
 
     getline(config, valueName); // flush the rest of the line
 }
+void CGameState::loadSpawnCount(std::ifstream &config)
+{
+    std::streampos start = config.tellg();
+    std::string valueName;
+    getline(config, valueName, ':');
+    if (valueName != "SPAWN_COUNT") // the line is optional, configs written before it go on with WINDOW_SCALE
+    {
+        config.clear();
+        config.seekg(start);
+        return;
+    }
+
+    if (!(config >> SPAWN_COUNT) || SPAWN_COUNT < 1 || SPAWN_COUNT > MAX_SPAWN_COUNT)
+        throw std::invalid_argument("unable to read spawn count");
+
+    getline(config, valueName); // flush the rest of the line
+}
 void CGameState::loadWindowScale(std::ifstream &config)
 {
     std::string valueName;
@@ -78,8 +100,8 @@ void CGameState::loadWindowScale(std::ifstream &config)
 
     getline(config, valueName); // flush the rest of the line
 
-    WINDOW_WIDTH = WINDOW_SCALE * gameMap.BOARDWIDTH; // recalcuate window width and window height
-    WINDOW_HEIGHT = WINDOW_SCALE * gameMap.BOARDHEIGHT;
+    WINDOW_WIDTH = WINDOW_SCALE * VIEW_WIDTH; // recalcuate window width and window height
+    WINDOW_HEIGHT = WINDOW_SCALE * VIEW_HEIGHT;
 }
 void CGameState::loadBottomPadding(std::ifstream &config)
 {
@@ -99,27 +121,39 @@ void CGameState::loadFontSize(std::ifstream &config)
 
     getline(config, valueName); // flush the rest of the line
 }
-void CGameState::loadBoardWidth(std::ifstream &config)
+int CGameState::loadBoardWidth(std::ifstream &config)
 {
     std::string valueName;
     getline(config, valueName, ':');
-    if (valueName != "BOARD_WIDTH" || !(config >> gameMap.BOARDWIDTH))
+    int width = 0;
+    if (valueName != "BOARD_WIDTH" || !(config >> width))
         throw std::invalid_argument("unable to read board width");
+    if (width < 1 || width > CGameMap::MAX_SIZE)
+        throw std::invalid_argument("board width out of range");
 
     getline(config, valueName); // flush the rest of the line
+    return width;
 }
-void CGameState::loadBoardHeight(std::ifstream &config)
+int CGameState::loadBoardHeight(std::ifstream &config)
 {
     std::string valueName;
     getline(config, valueName, ':');
-    if (valueName != "BOARD_HEIGHT" || !(config >> gameMap.BOARDHEIGHT))
+    int height = 0;
+    if (valueName != "BOARD_HEIGHT" || !(config >> height))
         throw std::invalid_argument("unable to read board height");
+    if (height < 1 || height > CGameMap::MAX_SIZE)
+        throw std::invalid_argument("board height out of range");
 
     getline(config, valueName); // flush the rest of the line
+    return height;
 }
 
 CGameMap::CMapObjects ASCIIToMapObject(char c)
 {
+    CGameMap::CMapObjects ghost;
+    if (CGhostStore::findObject(c, ghost)) // the ghost glyphs are listed by their personalities
+        return ghost;
+
     switch (c)
     {
     case 'W':
@@ -128,12 +162,6 @@ CGameMap::CMapObjects ASCIIToMapObject(char c)
         return CGameMap::CMapObjects::C;
     case 'S':
         return CGameMap::CMapObjects::S;
-    case 'm':
-        return CGameMap::CMapObjects::m;
-    case 't':
-        return CGameMap::CMapObjects::t;
-    case 'e':
-        return CGameMap::CMapObjects::e;
     case 'P':
         return CGameMap::CMapObjects::P;
     default:
@@ -141,60 +169,151 @@ CGameMap::CMapObjects ASCIIToMapObject(char c)
     }
 }
 
-void CGameState::loadBoard(std::ifstream &config)
+void CGameState::loadBoard(std::ifstream &config, int width, int height)
 {
     std::string boardLine;
     if (!getline(config, boardLine)) // flush the first line
         throw std::invalid_argument("unable to read game board");
 
+    // the size only changes together with the chunks, a config that breaks off before the board keeps the map as it was
+    gameMap.BOARDWIDTH = width;
+    gameMap.BOARDHEIGHT = height;
+    gameMap.clear();
+    levelFile.reset();
+
     for (int i = 0; i < gameMap.BOARDHEIGHT; i++)
     {
-        if (!getline(config, boardLine))
+        if (!getline(config, boardLine) || static_cast<int>(boardLine.size()) < gameMap.BOARDWIDTH)
             throw std::invalid_argument("unable to read game board");
 
         for (int j = 0; j < gameMap.BOARDWIDTH; j++)
-            gameMap.map[i][j] = ASCIIToMapObject(boardLine[j]);
+            gameMap.setTile(j, i, ASCIIToMapObject(boardLine[j]));
     }
 }
 
-void CGameState::loadConfig()
+void CGameState::loadLevel(const std::string &path)
+{
+    std::shared_ptr<const CLevelFile> level = CLevelFile::load(path);
+    const CLevelHeader &header = level->getHeader();
+
+    PLAYER_SPEED = header.playerSpeed;
+    POWER_UP_GHOST_SLOWDOWN = header.powerUpGhostSlowdown;
+    INITIAL_POWERUP_TIME = header.initialPowerUpTime;
+    POWER_UP_TIME_DECREMENT = header.powerUpTimeDecrement;
+    TIME_BETWEEN_GUARD_MODE = header.timeBetweenGuardMode;
+    INITIAL_GUARD_TIME = header.initialGuardTime;
+    GUARD_TIME_DECREMENT = header.guardTimeDecrement;
+    SPAWN_COUNT = header.spawnCount;
+    WINDOW_SCALE = header.windowScale;
+    BOTTOM_PADDING = header.bottomPadding;
+    FONT_SIZE = header.fontSize;
+
+    gameMap.BOARDWIDTH = header.width;
+    gameMap.BOARDHEIGHT = header.height;
+    gameMap.coinCount = header.coinCount;
+    gameMap.attach(level->getTiles(), level->getEntities(), header.entityCount, level->getExits());
+    levelFile = level;
+}
+
+bool CGameState::loadConfig(const std::string &path)
 {
-    std::ifstream config("./src/settings.conf");
-    if (config.is_open())
+    bool loaded = false;
+
+    if (CLevelFile::isLevelFile(path))
     {
         try
         {
-            loadSpeed(config);
-            loadPowerUpGhostSlowdown(config);
-
-            loadInitialPowerUpTime(config);
-            loadPowerUpTimeDecrement(config);
-
-            loadTimeBetweenGuardMode(config);
-            loadInitialGuardTime(config);
-            loadGuardTimeDecrement(config);
-
-            loadWindowScale(config);
-            loadBottomPadding(config);
-            loadFontSize(config);
-
-            loadBoardWidth(config);
-            loadBoardHeight(config);
-
-            loadBoard(config);
+            loadLevel(path);
+            loaded = true;
         }
         catch (std::invalid_argument &e)
         {
-            std::cout << e.what() << " Please check the settings file." << std::endl;
+            std::cout << e.what() << " Please check the level file." << std::endl;
         }
+    }
+    else
+    {
+        std::ifstream config(path);
+        if (config.is_open())
+        {
+            try
+            {
+                loadSpeed(config);
+                loadPowerUpGhostSlowdown(config);
+
+                loadInitialPowerUpTime(config);
+                loadPowerUpTimeDecrement(config);
+
+                loadTimeBetweenGuardMode(config);
+                loadInitialGuardTime(config);
+                loadGuardTimeDecrement(config);
+                loadSpawnCount(config);
+
+                loadWindowScale(config);
+                loadBottomPadding(config);
+                loadFontSize(config);
+
+                int width = loadBoardWidth(config);
+                int height = loadBoardHeight(config);
+
+                loadBoard(config, width, height);
+                loaded = true;
+            }
+            catch (std::invalid_argument &e)
+            {
+                std::cout << e.what() << " Please check the settings file." << std::endl;
+            }
+
+            config.close();
+        }
+        else
+            std::cout << "Error loading settings. Using default settings instead." << std::endl;
 
-        config.close();
+        gameMap.compile();
     }
+
+    VIEW_WIDTH = std::min(gameMap.BOARDWIDTH, MAX_VIEW_SIZE); ///< recalculate width and height based on loaded data
+    VIEW_HEIGHT = std::min(gameMap.BOARDHEIGHT, MAX_VIEW_SIZE);
+    WINDOW_WIDTH = WINDOW_SCALE * VIEW_WIDTH;
+    WINDOW_HEIGHT = WINDOW_SCALE * VIEW_HEIGHT;
+
+    powerUpTime = INITIAL_POWERUP_TIME; // the initializers of these ran before the config was loaded
+    guardTime = INITIAL_GUARD_TIME;
+    nextGuard = TIME_BETWEEN_GUARD_MODE;
+
+    return loaded;
+}
+
+void CGameState::setParameter(const std::string &name, const std::string &value)
+{
+    std::istringstream stream(value);
+    bool valid;
+
+    if (name == "PLAYER_SPEED")
+        valid = static_cast<bool>(stream >> PLAYER_SPEED);
+    else if (name == "POWER_UP_GHOST_SLOWDOWN")
+        valid = static_cast<bool>(stream >> POWER_UP_GHOST_SLOWDOWN);
+    else if (name == "INITIAL_POWERUP_TIME")
+        valid = static_cast<bool>(stream >> INITIAL_POWERUP_TIME);
+    else if (name == "POWER_UP_TIME_DECREMENT")
+        valid = static_cast<bool>(stream >> POWER_UP_TIME_DECREMENT);
+    else if (name == "TIME_BETWEEN_GUARD_MODE")
+        valid = static_cast<bool>(stream >> TIME_BETWEEN_GUARD_MODE);
+    else if (name == "INITIAL_GUARD_TIME")
+        valid = static_cast<bool>(stream >> INITIAL_GUARD_TIME);
+    else if (name == "GUARD_TIME_DECREMENT")
+        valid = static_cast<bool>(stream >> GUARD_TIME_DECREMENT);
+    else if (name == "SPAWN_COUNT")
+        valid = (stream >> SPAWN_COUNT) && SPAWN_COUNT >= 1 && SPAWN_COUNT <= MAX_SPAWN_COUNT;
     else
-        std::cout << "Error loading settings. Using default settings instead." << std::endl;
+        throw std::invalid_argument("unknown parameter " + name);
 
-    WINDOW_WIDTH = WINDOW_SCALE * gameMap.BOARDWIDTH; ///< recalculate width and height based on loaded data
-    WINDOW_HEIGHT = WINDOW_SCALE * gameMap.BOARDHEIGHT;
+    if (!valid || !(stream >> std::ws).eof()) // the whole value has to be read, "4.5" is not a valid speed
+        throw std::invalid_argument("unable to read " + name + " value " + value);
+
+    powerUpTime = INITIAL_POWERUP_TIME;
+    guardTime = INITIAL_GUARD_TIME;
+    nextGuard = TIME_BETWEEN_GUARD_MODE;
 }
 
 bool CGameState::isNextMoveLegal()
@@ -209,44 +328,22 @@ bool CGameState::isThisMoveLegal()
 
 bool CGameState::isAMoveLegal(CDirection move, CPos pos)
 {
-    std::pair<int, int> intPos = pos.getIntPos();
-    const double threshold = 0.05; // Experimentaly set. Needs to be low enough so that the position is close to a whole number and high enough that we do not skip it between two frames.
-
-    if (move == CDirection::left)
-        if ((intPos.first > 0 &&                                          // prevents a segfault if the player is at the very edge of the map
-             gameMap.map[intPos.second][intPos.first - 1] == gameMap.W && // check if there is a wall
-             pos.x - intPos.first < threshold) ||                         // check that the x position is close to a whole number. We can't just cast because we are approaching the whole number from the bottom
-
-            (pos.y - intPos.second > threshold)) // we are too far from a whole number
-
-            return false;
-
-    if (move == CDirection::right)
-        if ((intPos.first < gameMap.BOARDWIDTH - 1 &&                      // prevents a segfault if the player is at the very edge of the map
-             gameMap.map[intPos.second][intPos.first + 1] == gameMap.W) || // check if there is a wall
-
-            (pos.y - intPos.second > threshold)) // we are too far from a whole number
-
-            return false;
-
-    if (move == CDirection::up)
-        if ((intPos.second > 0 &&                                         // prevents a segfault if the player is at the very edge of the map
-             gameMap.map[intPos.second - 1][intPos.first] == gameMap.W && // check if there is a wall
-             pos.y - intPos.second < threshold) ||                        // check that the y position is close to a whole number. We can't just cast because we are approaching the whole number from the bottom
-
-            (pos.x - intPos.first > threshold)) // we are too far from a whole number
-
-            return false;
-
-    if (move == CDirection::down)
-        if ((intPos.second < gameMap.BOARDHEIGHT - 1 &&                    // prevents a segfault if the player is at the very edge of the map
-             gameMap.map[intPos.second + 1][intPos.first] == gameMap.W) || // check if there is a wall
+    return gameMap.graph.isLegal(move, pos);
+}
 
-            (pos.x - intPos.first > threshold)) // we are too far from a whole number
+void CGameState::scaleTimers()
+{
+    powerUpTime = INITIAL_POWERUP_TIME;
+    guardTime = INITIAL_GUARD_TIME;
 
-            return false;
+    for (int i = 1; i < level; i++)
+    {
+        if (guardTime > 1)
+            guardTime -= GUARD_TIME_DECREMENT;
 
-    return true;
+        if (powerUpTime > 1)
+            powerUpTime -= POWER_UP_TIME_DECREMENT;
+    }
 }
 
 void CGameState::updateMoves()
@@ -285,6 +382,48 @@ void CGameState::updatePos(double deltaTime)
 
 void CGameState::saveScore()
 {
-    highscores.push_back({score, level});
-    std::sort(highscores.rbegin(), highscores.rend());
+    if (!scorePending)
+        return;
+
+    scorePending = false;
+    if (!highscores.add(score, level))
+        std::cout << "An error occured while saving the score." << std::endl;
+}
+
+void CGameState::saveState(CGameSnapshot &snapshot) const
+{
+    snapshot.write(level);
+    snapshot.write(score);
+    snapshot.write(playerPos);
+    snapshot.write(previousPlayerPos);
+    snapshot.write(powerUpTime);
+    snapshot.write(powerUpRemaining);
+    snapshot.write(guardTime);
+    snapshot.write(guardTimeRemaining);
+    snapshot.write(nextGuard);
+    snapshot.write(screen);
+    snapshot.write(scorePending);
+    snapshot.write(thisMove);
+    snapshot.write(nextMove);
+    snapshot.write(gamemode);
+    snapshot.write(gameMap.coinCount);
+}
+
+bool CGameState::restoreState(const CGameSnapshot &snapshot, size_t &offset)
+{
+    return snapshot.read(offset, level) &&
+           snapshot.read(offset, score) &&
+           snapshot.read(offset, playerPos) &&
+           snapshot.read(offset, previousPlayerPos) &&
+           snapshot.read(offset, powerUpTime) &&
+           snapshot.read(offset, powerUpRemaining) &&
+           snapshot.read(offset, guardTime) &&
+           snapshot.read(offset, guardTimeRemaining) &&
+           snapshot.read(offset, nextGuard) &&
+           snapshot.read(offset, screen) &&
+           snapshot.read(offset, scorePending) &&
+           snapshot.read(offset, thisMove) &&
+           snapshot.read(offset, nextMove) &&
+           snapshot.read(offset, gamemode) &&
+           snapshot.read(offset, gameMap.coinCount);
 }
\ No newline at end of file
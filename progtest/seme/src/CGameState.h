@@ -3,10 +3,18 @@
 #include "CPos.h"
 #include "CGameMap.h"
 #include "CDirection.h"
+#include "CDistanceTable.h"
+#include "CScoreStore.h"
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 #include <fstream>
+#include <string>
+#include <memory>
+
+class CLevelFile;
+class CGameSnapshot;
 
 /** \class CGameState
  A collection of variables and constants used as a context for other functions and methods.
@@ -23,13 +31,17 @@ struct CGameState
     int INITIAL_GUARD_TIME = 10;      ///< Seconds. configuration constant loaded from a config file. If no config file is present, or the loading fails, the default is used.
     int GUARD_TIME_DECREMENT = 1;     ///< Seconds, decrement on level increase. Configuration constant loaded from a config file. If no config file is present, or the loading fails, the default is used.
 
-    int WINDOW_SCALE = 30;    ///< Window scale * board width is the window width in pixels. Same goes for height. Configuration constant loaded from a config file. If no config file is present, or the loading fails, the default is used.
+    static constexpr int MAX_SPAWN_COUNT = 1 << 16; ///< the most ghosts a single ghost start tile spawns
+    int SPAWN_COUNT = 1;                            ///< Ghosts spawned by every ghost start tile, on the walkable tiles nearest to it. Optional configuration constant loaded from a config file. If it is not present, the default is used.
+
+    int WINDOW_SCALE = 30;    ///< Window scale * visible board width is the window width in pixels. Same goes for height. Configuration constant loaded from a config file. If no config file is present, or the loading fails, the default is used.
     int BOTTOM_PADDING = 100; ///< Pixels. Configuration constant loaded from a config file. If no config file is present, or the loading fails, the default is used.
     int FONT_SIZE = 20;       ///< No idea what's the unit. Check TTF_OpenFont documentation. Configuration constant loaded from a config file. If no config file is present, or the loading fails, the default is used.
 
-    int level = 1;  ///< current level
-    int score = 0;  ///< current score
-    CPos playerPos; ///< current position of the player
+    int level = 1;          ///< current level
+    int score = 0;          ///< current score
+    CPos playerPos;         ///< current position of the player
+    CPos previousPlayerPos; ///< position of the player before the last update, used for render interpolation
 
     double powerUpTime = INITIAL_POWERUP_TIME; ///< power up time corresponding to the current level
     double powerUpRemaining = 0;               ///< active power up time remaining
@@ -59,15 +71,23 @@ struct CGameState
         powerup ///< The player can eat the ghosts.
     };
 
-    std::vector<std::pair<int, int>> highscores; ///< vector of high scores, sorted highest to lowest.
-    CScreen screen = CScreen::start;             ///< currently active screen
-    CDirection thisMove = CDirection::none;      ///< player move that is currently being executed
-    CDirection nextMove = CDirection::none;      ///< player move that is next in line. It will either be cached or executed on the next update.
-    CGameMode gamemode;                          ///< used to guide ghost behavior and enable eating interaction.
-    CGameMap gameMap;                            ///< used to specify the postions of all game elements on game start
+    CScoreStore highscores;                 ///< the best scores, also logged to the disk once the store is opened
+    CScreen screen = CScreen::start;        ///< currently active screen
+    bool scorePending = false;              ///< true from the moment the player is caught until saveScore logs the score
+    CDirection thisMove = CDirection::none; ///< player move that is currently being executed
+    CDirection nextMove = CDirection::none; ///< player move that is next in line. It will either be cached or executed on the next update.
+    CGameMode gamemode;                     ///< used to guide ghost behavior and enable eating interaction.
+    CGameMap gameMap;                       ///< used to specify the postions of all game elements on game start
+
+    std::shared_ptr<const CDistanceTable> distanceTable; ///< maze distances between the tiles of gameMap, shared by copies of the gamestate. Null if the map is too large.
+    std::shared_ptr<const CLevelFile> levelFile;         ///< the mapped level file gameMap is attached to, shared by copies of the gamestate. Null if the map was loaded from text.
 
-    int WINDOW_WIDTH = WINDOW_SCALE * gameMap.BOARDWIDTH;   ///< Window width in pixels
-    int WINDOW_HEIGHT = WINDOW_SCALE * gameMap.BOARDHEIGHT; ///< Window height in pixels (bottom padding is not included)
+    static constexpr int MAX_VIEW_SIZE = 40; ///< Tiles. The most tiles shown in the window in either direction, the camera scrolls over boards that are larger.
+
+    int VIEW_WIDTH = std::min(gameMap.BOARDWIDTH, MAX_VIEW_SIZE);   ///< Tiles. Width of the part of the board shown in the window.
+    int VIEW_HEIGHT = std::min(gameMap.BOARDHEIGHT, MAX_VIEW_SIZE); ///< Tiles. Height of the part of the board shown in the window.
+    int WINDOW_WIDTH = WINDOW_SCALE * VIEW_WIDTH;                   ///< Window width in pixels
+    int WINDOW_HEIGHT = WINDOW_SCALE * VIEW_HEIGHT;                 ///< Window height in pixels (bottom padding is not included)
 
     ////////////////////////////////////////////////////////////////////////////////
     /// Checks if the next player move is legal
@@ -78,7 +98,7 @@ struct CGameState
     bool isThisMoveLegal();
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// Checks if a move from a position is legal
+    /// Checks if a move from a position is legal. Answered by the exit masks of the maze graph, the same table the ghosts move by.
     ///
     /// @param [in] move the move being checked
     /// @param [in] pos move is from this position
@@ -95,12 +115,42 @@ struct CGameState
     void updatePos(double deltaTime);
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// Saves the current score to the highscores vector.
+    /// Sets the power up and guard times of the current level. Both are decremented on every level increase, as long as they are longer than a second.
+    void scaleTimers();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Adds the current score to the high scores if the player was caught and it was not added yet. The score is logged when the game over screen is left,
+    /// not when the player is caught, so that a game rewound past its end and lost again is not logged twice.
     void saveScore();
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// Loads all of the constants from the config file.
-    void loadConfig();
+    /// Appends the variables that change during a game to a snapshot. The configuration constants, the map and the highscores are not saved.
+    ///
+    /// @param [out] snapshot the snapshot written to
+    void saveState(CGameSnapshot &snapshot) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Reads the variables saved by saveState back from a snapshot.
+    ///
+    /// @param [in] snapshot the snapshot read from
+    /// @param [in, out] offset where the state starts, moved past it
+    /// @return false if the snapshot is broken
+    bool restoreState(const CGameSnapshot &snapshot, size_t &offset);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Loads all of the constants from the config file. A level file compiled by svobov25-compile is recognized by its signature and mapped instead.
+    ///
+    /// @param [in] path path to the config file or the level file
+    /// @return true if the whole file was loaded, false if the defaults (or a part of them) are used
+    bool loadConfig(const std::string &path = "./src/settings.conf");
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Overrides one of the gameplay constants of the config file, e.g. for a parameter sweep. The values derived from it are updated as well.
+    ///
+    /// @param [in] name name of the constant, as written in the config file
+    /// @param [in] value the new value, as written in the config file
+    /// @throws std::invalid_argument if the name is unknown or the value cannot be read
+    void setParameter(const std::string &name, const std::string &value);
 
     ////////////////////////////////////////////////////////////////////////////////
     /// Loads PLAYER_SPEED from an ifstream
@@ -144,6 +194,12 @@ struct CGameState
     /// @param [in] config Ifstream that is being loaded
     void loadGuardTimeDecrement(std::ifstream &config);
 
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Loads SPAWN_COUNT from an ifstream, if its line is present. Otherwise the stream is left where it was.
+    ///
+    /// @param [in] config Ifstream that is being loaded
+    void loadSpawnCount(std::ifstream &config);
+
     ////////////////////////////////////////////////////////////////////////////////
     /// Loads WINDOW_SCALE from an ifstream
     ///
@@ -163,20 +219,31 @@ struct CGameState
     void loadFontSize(std::ifstream &config);
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// Loads BOARD_WIDTH from an ifstream
+    /// Loads BOARD_WIDTH from an ifstream. It is only applied by loadBoard.
     ///
     /// @param [in] config Ifstream that is being loaded
-    void loadBoardWidth(std::ifstream &config);
+    /// @return the width of the board
+    int loadBoardWidth(std::ifstream &config);
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// Loads BOARD_HEIGHT from an ifstream
+    /// Loads BOARD_HEIGHT from an ifstream. It is only applied by loadBoard.
     ///
     /// @param [in] config Ifstream that is being loaded
-    void loadBoardHeight(std::ifstream &config);
+    /// @return the height of the board
+    int loadBoardHeight(std::ifstream &config);
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// Loads the game map from an ifstream
+    /// Loads the game map from an ifstream. The size of the map is set right before its tiles are read, so the map stays as it was if the board is missing.
     ///
     /// @param [in] config Ifstream that is being loaded
-    void loadBoard(std::ifstream &config);
+    /// @param [in] width width of the board, as returned by loadBoardWidth
+    /// @param [in] height height of the board, as returned by loadBoardHeight
+    void loadBoard(std::ifstream &config, int width, int height);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Maps a compiled level file and attaches the map to it. Nothing is changed if the file is broken.
+    ///
+    /// @param [in] path path to the level file
+    /// @throws std::invalid_argument if the file cannot be loaded
+    void loadLevel(const std::string &path);
 };
\ No newline at end of file
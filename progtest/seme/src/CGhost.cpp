@@ -1,9 +1,73 @@
 #include "CGhost.h"
-#include <vector>
-#include <iostream>
+#include "CGameSnapshot.h"
 
-void CGhost::updatePos(CGameState &gamestate, double deltaTime, double speed)
+void CGhostArrays::clear()
 {
+    startPos.clear();
+    currentPos.clear();
+    previousPos.clear();
+    nextPos.clear();
+    direction.clear();
+    corridor.clear();
+    deciding.clear();
+    decidingPos.clear();
+    legalMoves.clear();
+    grid.clear();
+    guardTileFound = false;
+}
+
+void CGhostArrays::add(CPos pos)
+{
+    startPos.push_back(pos);
+    currentPos.push_back(pos);
+    previousPos.push_back(pos);
+    nextPos.push_back(pos);
+    direction.push_back(CDirection::none);
+    corridor.push_back({});
+    deciding.push_back(0);
+    decidingPos.push_back(pos);
+    legalMoves.push_back(0);
+    grid.add(pos);
+}
+
+size_t CGhostArrays::size() const
+{
+    return currentPos.size();
+}
+
+void CGhostArrays::saveState(CGameSnapshot &snapshot) const
+{
+    snapshot.writeArray(currentPos);
+    snapshot.writeArray(previousPos);
+    snapshot.writeArray(nextPos);
+    snapshot.writeArray(direction);
+    snapshot.write(guardTile);
+    snapshot.write(guardTileFound);
+}
+
+bool CGhostArrays::restoreState(const CGameSnapshot &snapshot, size_t &offset)
+{
+    size_t count = size();
+
+    // the legal moves are refreshed in every update, the grid follows the positions and the corridors are found again, they are not part of the state
+    if (!(snapshot.readArray(offset, currentPos) && currentPos.size() == count &&
+          snapshot.readArray(offset, previousPos) && previousPos.size() == count &&
+          snapshot.readArray(offset, nextPos) && nextPos.size() == count &&
+          snapshot.readArray(offset, direction) && direction.size() == count &&
+          snapshot.read(offset, guardTile) &&
+          snapshot.read(offset, guardTileFound)))
+        return false;
+
+    grid.rebuild(currentPos);
+    std::fill(corridor.begin(), corridor.end(), CCorridor());
+    return true;
+}
+
+void CGhost::updatePos(CGhostArrays &ghosts, size_t ghost, CGameState &gamestate, double deltaTime, double speed)
+{
+    CPos &currentPos = ghosts.currentPos[ghost];
+    CDirection direction = ghosts.direction[ghost];
+
     if (direction == CDirection::up)
         currentPos.y -= speed * deltaTime;
     else if (direction == CDirection::down)
@@ -22,110 +86,118 @@ void CGhost::updatePos(CGameState &gamestate, double deltaTime, double speed)
         currentPos.x -= gamestate.gameMap.BOARDWIDTH;
     else if (currentPos.y > gamestate.gameMap.BOARDHEIGHT)
         currentPos.y -= gamestate.gameMap.BOARDHEIGHT;
+
+    ghosts.grid.move(ghost, currentPos);
 }
 
-void CGhost::setTargetPos(CGameState &gamestate)
+void CGhost::handlePlayerCollisions(CGhostArrays &ghosts, CGameState &gamestate)
 {
-    if (gamestate.gamemode == CGameState::CGameMode::guard)
-        targetPos = getGuardPos(gamestate);
-    else
-        targetPos = gamestate.playerPos;
+    // the next ghost is found before the collision is handled, a ghost eaten during a power up moves to another tile.
+    // The first ghost that catches the player ends the game, the ghosts after it (of this or a later personality) are not handled
+    uint32_t next;
+    for (uint32_t ghost = ghosts.grid.findFirst(gamestate.playerPos);
+         ghost != CGhostGrid::NONE && gamestate.screen != CGameState::CScreen::gameOver; ghost = next)
+    {
+        next = ghosts.grid.findNext(ghost);
+        handlePlayerCollision(ghosts, ghost, gamestate);
+    }
 }
 
-void CGhost::handlePlayerCollision(CGameState &gamestate)
+void CGhost::handlePlayerCollision(CGhostArrays &ghosts, size_t ghost, CGameState &gamestate)
 {
     if (gamestate.gamemode == CGameState::CGameMode::powerup)
     {
         gamestate.score += 400;
-        currentPos = startPos;
+        ghosts.currentPos[ghost] = ghosts.startPos[ghost];
+        ghosts.grid.move(ghost, ghosts.startPos[ghost]);
+        ghosts.corridor[ghost] = CCorridor();
     }
     else
     {
-        gamestate.saveScore();
+        gamestate.scorePending = true;
         gamestate.screen = CGameState::CScreen::gameOver;
     }
 }
 
-void CGhost::update(CGameState &gamestate, double deltaTime)
+bool CGhost::isInCorridor(CPos pos, CDirection direction, const CCorridor &corridor)
 {
-    double speed = gamestate.PLAYER_SPEED;
-    if (gamestate.gamemode == CGameState::CGameMode::powerup)
-        speed *= gamestate.POWER_UP_GHOST_SLOWDOWN;
+    // past the center of the node it left (the fraction is exact, like in CMazeGraph::getLegalMoves) and before the node ahead.
+    // Moving up or left, the node ahead is entered from its far side, it is only reached close to its center
+    switch (direction)
+    {
+    case CDirection::right:
+        return pos.x - corridor.from > CMazeGraph::THRESHOLD && pos.x < corridor.to;
+    case CDirection::down:
+        return pos.y - corridor.from > CMazeGraph::THRESHOLD && pos.y < corridor.to;
+    case CDirection::left:
+        return pos.x < corridor.from && pos.x - corridor.to > CMazeGraph::THRESHOLD;
+    case CDirection::up:
+        return pos.y < corridor.from && pos.y - corridor.to > CMazeGraph::THRESHOLD;
+    default:
+        return false;
+    }
+}
 
-    setTargetPos(gamestate);
+void CGhost::enterCorridor(CGhostArrays &ghosts, size_t ghost, const CGameState &gamestate)
+{
+    CPos pos = ghosts.currentPos[ghost];
+    CDirection direction = ghosts.direction[ghost];
+    std::pair<int, int> tile = pos.getIntPos();
+    bool horizontal = direction == CDirection::left || direction == CDirection::right;
 
-    if (currentPos == gamestate.playerPos)
-        handlePlayerCollision(gamestate);
+    // off the center line, the moves to the sides stay legal (see CMazeGraph::getLegalMoves), and tunnel positions are truncated toward zero
+    double across = horizontal ? pos.y - tile.second : pos.x - tile.first;
+    CMazeGraph::CEdge edge;
+    ghosts.corridor[ghost] = CCorridor();
 
-    getNextPos(gamestate);
-    updatePos(gamestate, deltaTime, speed);
+    if (pos.x < 0 || pos.y < 0 || across >= CMazeGraph::THRESHOLD ||
+        !gamestate.gameMap.graph.getEdge(tile.first, tile.second, direction, edge))
+        return;
+
+    ghosts.corridor[ghost] = horizontal ? CCorridor{tile.first, edge.x} : CCorridor{tile.second, edge.y};
 }
 
-void CGhost::findPossibleMoves(CGameState &gamestate, std::vector<std::pair<CPos, CDirection>> &possibleMoves)
+int CGhost::findPossibleMoves(CPos pos, CDirection direction, uint8_t legalMoves, CMove possibleMoves[4])
 {
-    std::pair<int, int> intPos = currentPos.getIntPos();
+    std::pair<int, int> intPos = pos.getIntPos();
+    int moveCount = 0;
+
+    if ((legalMoves & CMazeGraph::getBit(CDirection::up)) && direction != CDirection::down) // ghost cannot turn around when in a tunnel
+        possibleMoves[moveCount++] = {CPos(intPos.first, intPos.second - 1), CDirection::up};
 
-    if (gamestate.isAMoveLegal(CDirection::up, currentPos) && direction != CDirection::down) // ghost cannot turn around when in a tunnel
-        possibleMoves.push_back({CPos(intPos.first, intPos.second - 1), CDirection::up});
+    if ((legalMoves & CMazeGraph::getBit(CDirection::down)) && direction != CDirection::up)
+        possibleMoves[moveCount++] = {CPos(intPos.first, intPos.second + 1), CDirection::down};
 
-    if (gamestate.isAMoveLegal(CDirection::down, currentPos) && direction != CDirection::up)
-        possibleMoves.push_back({CPos(intPos.first, intPos.second + 1), CDirection::down});
+    if ((legalMoves & CMazeGraph::getBit(CDirection::left)) && direction != CDirection::right)
+        possibleMoves[moveCount++] = {CPos(intPos.first - 1, intPos.second), CDirection::left};
 
-    if (gamestate.isAMoveLegal(CDirection::left, currentPos) && direction != CDirection::right)
-        possibleMoves.push_back({CPos(intPos.first - 1, intPos.second), CDirection::left});
+    if ((legalMoves & CMazeGraph::getBit(CDirection::right)) && direction != CDirection::left)
+        possibleMoves[moveCount++] = {CPos(intPos.first + 1, intPos.second), CDirection::right};
 
-    if (gamestate.isAMoveLegal(CDirection::right, currentPos) && direction != CDirection::left)
-        possibleMoves.push_back({CPos(intPos.first + 1, intPos.second), CDirection::right});
+    return moveCount;
 }
 
-void CGhost::pickBestMove(CGameState &gamestate, std::vector<std::pair<CPos, CDirection>> &possibleMoves)
+double CGhost::getSpeed(const CGameState &gamestate)
 {
-    if (!possibleMoves.empty())
-    {
-        direction = possibleMoves[0].second;
-        nextPos = possibleMoves[0].first;
-    }
-    else
-        direction = CDirection::none;
+    double speed = gamestate.PLAYER_SPEED;
+    if (gamestate.gamemode == CGameState::CGameMode::powerup)
+        speed *= gamestate.POWER_UP_GHOST_SLOWDOWN;
 
-    for (auto move : possibleMoves)
-    {
-        // while chasing, we want to pick the position closest to the player
-        if (gamestate.gamemode != CGameState::CGameMode::powerup &&
-            getNorm(nextPos - targetPos) > getNorm(move.first - targetPos))
-        {
-            direction = move.second;
-            nextPos = move.first;
-        }
-        // during a power up, we pick the opposite
-        else if (gamestate.gamemode == CGameState::CGameMode::powerup &&
-                 getNorm(nextPos - targetPos) < getNorm(move.first - targetPos))
-        {
-            direction = move.second;
-            nextPos = move.first;
-        }
-    }
+    return speed;
 }
-void CGhost::getNextPos(CGameState &gamestate)
+
+bool CGhost::isCruising(const CGameState &gamestate, CPos pos, CDirection direction, CPos &nextPos)
 {
-    std::vector<std::pair<CPos, CDirection>> possibleMoves;
+    CMove possibleMoves[4];
+    int moveCount = findPossibleMoves(pos, direction, gamestate.gameMap.graph.getLegalMoves(pos), possibleMoves);
 
-    findPossibleMoves(gamestate, possibleMoves);
-    pickBestMove(gamestate, possibleMoves);
-}
+    if (moveCount == 0) // the ghost stops, or keeps standing
+        return direction == CDirection::none;
 
-void CGhost::drawGhost(SDL_Renderer *renderer, CGameState &gamestate, int R, int G, int B)
-{
-    if (gamestate.gamemode != CGameState::CGameMode::powerup)
-        SDL_SetRenderDrawColor(renderer, R, G, B, 255);
-    else
-        SDL_SetRenderDrawColor(renderer, 0, 0, 180, 255);
-
-    SDL_Rect ghost =
-        {
-            static_cast<int>(gamestate.WINDOW_WIDTH / static_cast<double>(gamestate.gameMap.BOARDWIDTH) * currentPos.x),
-            static_cast<int>(gamestate.WINDOW_HEIGHT / static_cast<double>(gamestate.gameMap.BOARDHEIGHT) * currentPos.y),
-            static_cast<int>(gamestate.WINDOW_WIDTH / (static_cast<double>(gamestate.gameMap.BOARDWIDTH))),
-            static_cast<int>(gamestate.WINDOW_HEIGHT / (static_cast<double>(gamestate.gameMap.BOARDHEIGHT)))};
-    SDL_RenderFillRect(renderer, &ghost);
+    // the same decision as in update, without a target. Only a single way forward can be taken without one
+    if (moveCount > 1 || possibleMoves[0].second != direction)
+        return false;
+
+    nextPos = possibleMoves[0].first;
+    return true;
 }
@@ -1,88 +1,315 @@
 #pragma once
-#include "CGameObject.h"
+#include "CGameState.h"
+#include "CCanvas.h"
 #include "CDirection.h"
+#include "CGhostGrid.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class CGameSnapshot;
+
+/** \class CCorridor
+The straight corridor a ghost is running through (see CMazeGraph::getEdge), as the coordinates of its two end nodes on the axis the ghost moves along.
+The positions inside it are where the ghost has nowhere to go but forward, from just past the center of the node it left to the node it is heading to.
+An empty corridor (from == to) holds no position.
+*/
+struct CCorridor
+{
+    int from = 0; ///< the coordinate of the node the ghost left
+    int to = 0;   ///< the coordinate of the node the ghost is heading to
+};
+
+/** \class CGhostArrays
+The state of all ghosts of one personality, stored as parallel arrays with one entry per ghost.
+
+The target and the guard tile only depend on the personality and the gamestate, so they are stored once for all of the ghosts.
+The grid finds the ghosts standing on a tile, it has to follow every change of currentPos.
+A ghost that is moved other than by its update (eaten, restored) has to leave its corridor.
+*/
+struct CGhostArrays
+{
+    std::vector<CPos> startPos;        ///< the starting position of every ghost
+    std::vector<CPos> currentPos;      ///< the position of every ghost right now
+    std::vector<CPos> previousPos;     ///< the position of every ghost before the last update, used for render interpolation
+    std::vector<CPos> nextPos;         ///< the tile every ghost chose at its last decision
+    std::vector<CDirection> direction; ///< the direction every ghost is moving
+    std::vector<CCorridor> corridor;   ///< the corridor every ghost is running through, an empty one if it has to decide on every update
+    std::vector<uint32_t> deciding;    ///< the ghosts deciding in the current update, only the first ones are used
+    std::vector<CPos> decidingPos;     ///< the positions of the deciding ghosts, in the same order
+    std::vector<uint8_t> legalMoves;   ///< the moves legal from the positions of the deciding ghosts, answered at once in every update
+    CGhostGrid grid;                   ///< the ghosts sorted by the tile of their current position
+    CPos guardTile;                    ///< the walkable tile nearest to the guard position, found on the first guard mode
+    bool guardTileFound = false;       ///< true if guardTile was already found
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Removes all ghosts.
+    void clear();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Adds a ghost standing at a position.
+    ///
+    /// @param [in] pos initial position
+    void add(CPos pos);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the number of ghosts.
+    size_t size() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Appends the moving state of the ghosts to a snapshot. The start positions belong to the level and are not saved.
+    ///
+    /// @param [out] snapshot the snapshot written to
+    void saveState(CGameSnapshot &snapshot) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Reads the moving state of the ghosts back from a snapshot and sorts them into the grid again. The ghosts leave their corridors.
+    /// The vectors keep their memory, so restoring allocates nothing.
+    ///
+    /// @param [in] snapshot the snapshot read from
+    /// @param [in, out] offset where the state starts, moved past it
+    /// @return false if the snapshot is broken or holds a different number of ghosts
+    bool restoreState(const CGameSnapshot &snapshot, size_t &offset);
+};
 
 /** \class CGhost
-An abstract class that serves as the parent class of individual ghost personalities
+The behavior shared by all ghost personalities. It runs over the arrays of one personality at a time.
+
+A personality is a class with a static getNorm and getGuardPos and a color (R, G, B), passed as a template parameter, so every call is resolved at compile time.
 */
-class CGhost : public CGameObject
+class CGhost
 {
 public:
-    CGhost(CPos pos) : startPos(pos), currentPos(pos), nextPos(pos){};
-
     ////////////////////////////////////////////////////////////////////////////////
-    /// Updates the ghost's position, checks collision with the player and gets his next move
+    /// Updates the ghosts' positions, checks collisions with the player and gets their next moves
     ///
-    /// @param [in] renderer a pointer to the SDL_Renderer
+    /// @param [in, out] ghosts the ghosts of the personality
+    /// @param [in, out] gamestate a gamestate instance
     /// @param [in] deltaTime time since last frame
-    virtual void update(CGameState &gamestate, double deltaTime) override;
+    template <class TPersonality>
+    static void update(CGhostArrays &ghosts, CGameState &gamestate, double deltaTime);
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// Draws the ghost on his actual position as a rectangle of the color specified.
+    /// Draws the ghosts as rectangles of the personality's color, interpolated between their previous and current positions.
+    ///
+    /// @param [in] ghosts the ghosts of the personality
+    /// @param [in] canvas the canvas to draw on
+    /// @param [in] gamemode the gamemode, the ghosts are blue while a power up is active
+    /// @param [in] alpha how far the renderer is between the previous and the current update, from 0 to 1
+    template <class TPersonality>
+    static void draw(const CGhostArrays &ghosts, CCanvas &canvas, CGameState::CGameMode gamemode, double alpha);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the speed of the ghosts in the current gamemode.
     ///
-    /// @param [in] renderer a pointer to the SDL_Renderer
     /// @param [in] gamestate a gamestate instance
-    /// @param [in] R red
-    /// @param [in] G green
-    /// @param [in] B blue
-    void drawGhost(SDL_Renderer *renderer, CGameState &gamestate, int R, int G, int B);
+    /// @return tiles/second
+    static double getSpeed(const CGameState &gamestate);
 
-protected:
     ////////////////////////////////////////////////////////////////////////////////
-    /// An abstract method who's implementation will return a specific norm of a vector.
+    /// Checks if a ghost at a position would just go on in its direction, i.e. if an update there would neither turn nor stop it nor look at the target.
+    /// Between two such positions a ghost moves in a straight line, which lets CEventSimulation skip its updates. Collisions with the player are not checked.
     ///
-    /// @param[in] position a 2-d vector
-    virtual double getNorm(CPos position) = 0;
+    /// @param [in] gamestate a gamestate instance
+    /// @param [in] pos the position of the ghost
+    /// @param [in] direction the direction the ghost is moving, none if it stands
+    /// @param [out] nextPos the position the update would take next, left unchanged for a ghost that stands
+    /// @return true if the update would only move the ghost on
+    static bool isCruising(const CGameState &gamestate, CPos pos, CDirection direction, CPos &nextPos);
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// An abstract method who's implementation will return the position the ghost will take in guard mode.
+    /// Checks if a ghost is inside its corridor. There, its only possible move is forward, so an update would just move it on without looking at it.
     ///
-    /// @param[in] gamestate a gamestate instance
-    virtual CPos getGuardPos(CGameState &gamestate) = 0;
+    /// @param[in] pos the position of the ghost
+    /// @param[in] direction the direction the ghost is moving
+    /// @param[in] corridor the corridor of the ghost
+    static bool isInCorridor(CPos pos, CDirection direction, const CCorridor &corridor);
+
+private:
+    typedef std::pair<CPos, CDirection> CMove; ///< a neighbouring tile and the direction leading to it
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// Finds all moves that are legal and stores them in the possibleMoves vector
+    /// Returns the target position of the personality, depending on if guard mode, power up or chase is currently active
     ///
+    /// @param[in, out] ghosts the ghosts of the personality, the guard tile is cached there
     /// @param[in] gamestate a gamestate instance
-    /// @param[out] possibleMoves a gamestate instance
-    void findPossibleMoves(CGameState &gamestate, std::vector<std::pair<CPos, CDirection>> &possibleMoves);
+    template <class TPersonality>
+    static CPos getTargetPos(CGhostArrays &ghosts, CGameState &gamestate);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Checks if a move is closer to the target than another one. Maze distances are used when both are known,
+    /// the personality's vector norm decides when they are equal or unknown.
+    ///
+    /// @param[in] distance the maze distance of the move being checked, -1 if unknown
+    /// @param[in] norm the norm of the move being checked
+    /// @param[in] otherDistance the maze distance of the move it is compared to, -1 if unknown
+    /// @param[in] otherNorm the norm of the move it is compared to
+    static bool isCloser(int distance, double norm, int otherDistance, double otherNorm);
 
     ////////////////////////////////////////////////////////////////////////////////
     /// Pick the best move out of possible moves. This is the move the ghost will take next.
     ///
+    /// All candidates are measured first and compared afterwards. The norm is inlined from the personality, so measuring them is a short loop without calls
+    /// (except for the library call of CEuclid's hypot) that the compiler can vectorize.
+    ///
+    /// @param[in, out] ghosts the ghosts of the personality
+    /// @param[in] ghost index of the ghost
     /// @param[in] gamestate a gamestate instance
-    /// @param[in] possibleMoves a gamestate instance
-    void pickBestMove(CGameState &gamestate, std::vector<std::pair<CPos, CDirection>> &possibleMoves);
+    /// @param[in] targetPos the target position
+    /// @param[in] possibleMoves the legal moves
+    /// @param[in] moveCount number of the legal moves
+    template <class TPersonality>
+    static void pickBestMove(CGhostArrays &ghosts, size_t ghost, CGameState &gamestate, CPos targetPos, const CMove possibleMoves[4], int moveCount);
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// Handle player collision accordingly, depending on if a power up is active.
+    /// Looks up the corridor a ghost enters after a decision, from the edge of the node it decided on. A ghost that did not decide on a node
+    /// (e.g. in a tunnel, or in a corridor after it was restored) or that is not on the center line of the corridor gets an empty one,
+    /// it decides again on the next update.
     ///
-    /// @param[in, out] gamestate a gamestate instance
-    void handlePlayerCollision(CGameState &gamestate);
+    /// @param[in, out] ghosts the ghosts of the personality
+    /// @param[in] ghost index of the ghost
+    /// @param[in] gamestate a gamestate instance
+    static void enterCorridor(CGhostArrays &ghosts, size_t ghost, const CGameState &gamestate);
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// Set target position accordingly, depending on if guard mode, power up or chase is currently active
+    /// Finds all moves that are legal, the way back excluded
     ///
+    /// @param[in] pos the position of the ghost
+    /// @param[in] direction the direction the ghost is moving
+    /// @param[in] legalMoves the moves legal from the position, as returned by CMazeGraph::getLegalMoves
+    /// @param[out] possibleMoves the legal moves
+    /// @return number of the legal moves
+    static int findPossibleMoves(CPos pos, CDirection direction, uint8_t legalMoves, CMove possibleMoves[4]);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Handles the collisions of the ghosts standing on the player's tile. Only these ghosts are visited, the grid finds them. Nothing is handled once
+    /// the game is over, so a game ends only once even if several ghosts catch the player together.
+    ///
+    /// @param[in, out] ghosts the ghosts of the personality
     /// @param[in, out] gamestate a gamestate instance
-    void setTargetPos(CGameState &gamestate);
+    static void handlePlayerCollisions(CGhostArrays &ghosts, CGameState &gamestate);
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// Find the next position the ghost will take. Checks legal moves and picks the best one.
+    /// Handle player collision accordingly, depending on if a power up is active.
     ///
-    /// @param[in] gamestate a gamestate instance
-    void getNextPos(CGameState &gamestate);
+    /// @param[in, out] ghosts the ghosts of the personality
+    /// @param[in] ghost index of the ghost
+    /// @param[in, out] gamestate a gamestate instance
+    static void handlePlayerCollision(CGhostArrays &ghosts, size_t ghost, CGameState &gamestate);
 
     ////////////////////////////////////////////////////////////////////////////////
     /// Update the ghost's position based on the direction he's going, speed and delta time.
     ///
+    /// @param[in, out] ghosts the ghosts of the personality
+    /// @param[in] ghost index of the ghost
     /// @param[in] gamestate a gamestate instance
     /// @param[in] deltaTime time since last frame
     /// @param[in] speed the speed of the ghost
-    void updatePos(CGameState &gamestate, double deltaTime, double speed);
-
-    const CPos startPos;                     ///< the starting position of the ghost
-    CPos currentPos;                         ///< the position the ghost right now
-    CPos nextPos;                            ///< the position the ghost will take next
-    CPos targetPos;                          ///< the position of the target, usually the player's position
-    CDirection direction = CDirection::none; ///< the direction the ghost is moving
-};
\ No newline at end of file
+    static void updatePos(CGhostArrays &ghosts, size_t ghost, CGameState &gamestate, double deltaTime, double speed);
+};
+
+template <class TPersonality>
+CPos CGhost::getTargetPos(CGhostArrays &ghosts, CGameState &gamestate)
+{
+    if (gamestate.gamemode != CGameState::CGameMode::guard)
+        return gamestate.playerPos;
+
+    // guard positions lie outside of the maze, the maze distance needs a tile that can be reached
+    if (!ghosts.guardTileFound && gamestate.distanceTable)
+    {
+        ghosts.guardTile = gamestate.distanceTable->getNearestTile(TPersonality::getGuardPos(gamestate));
+        ghosts.guardTileFound = true;
+    }
+
+    return ghosts.guardTileFound ? ghosts.guardTile : TPersonality::getGuardPos(gamestate);
+}
+
+inline bool CGhost::isCloser(int distance, double norm, int otherDistance, double otherNorm)
+{
+    if (distance >= 0 && otherDistance >= 0 && distance != otherDistance)
+        return distance < otherDistance;
+
+    return norm < otherNorm;
+}
+
+template <class TPersonality>
+void CGhost::pickBestMove(CGhostArrays &ghosts, size_t ghost, CGameState &gamestate, CPos targetPos, const CMove possibleMoves[4], int moveCount)
+{
+    if (moveCount == 0)
+    {
+        ghosts.direction[ghost] = CDirection::none;
+        return;
+    }
+
+    double norms[4];
+    int distances[4];
+
+    for (int i = 0; i < moveCount; i++)
+        norms[i] = TPersonality::getNorm(CPos(possibleMoves[i].first.x - targetPos.x, possibleMoves[i].first.y - targetPos.y));
+
+    for (int i = 0; i < moveCount; i++)
+        distances[i] = gamestate.distanceTable ? gamestate.distanceTable->getDistance(possibleMoves[i].first, targetPos) : -1;
+
+    // while chasing, we want to pick the position closest to the player. During a power up, we pick the opposite
+    bool flee = gamestate.gamemode == CGameState::CGameMode::powerup;
+    int best = 0;
+
+    for (int i = 1; i < moveCount; i++)
+        if (flee ? isCloser(distances[best], norms[best], distances[i], norms[i])
+                 : isCloser(distances[i], norms[i], distances[best], norms[best]))
+            best = i;
+
+    ghosts.direction[ghost] = possibleMoves[best].second;
+    ghosts.nextPos[ghost] = possibleMoves[best].first;
+}
+
+template <class TPersonality>
+void CGhost::update(CGhostArrays &ghosts, CGameState &gamestate, double deltaTime)
+{
+    double speed = getSpeed(gamestate);
+    CPos targetPos = getTargetPos<TPersonality>(ghosts, gamestate);
+    CMove possibleMoves[4];
+
+    // ghosts do not affect each other, so every ghost can finish one part of the update before the next part starts
+    std::copy(ghosts.currentPos.begin(), ghosts.currentPos.end(), ghosts.previousPos.begin());
+    handlePlayerCollisions(ghosts, gamestate);
+
+    // a ghost inside its corridor would only go forward, it is not evaluated until it reaches the next node.
+    // The legal moves of the others are answered in a single batch
+    size_t deciding = 0;
+    for (size_t ghost = 0; ghost < ghosts.size(); ghost++)
+        if (!isInCorridor(ghosts.currentPos[ghost], ghosts.direction[ghost], ghosts.corridor[ghost]))
+        {
+            ghosts.deciding[deciding] = ghost;
+            ghosts.decidingPos[deciding++] = ghosts.currentPos[ghost];
+        }
+
+    gamestate.gameMap.graph.getLegalMoves(ghosts.decidingPos.data(), ghosts.legalMoves.data(), deciding);
+
+    for (size_t i = 0; i < deciding; i++)
+    {
+        size_t ghost = ghosts.deciding[i];
+        int moveCount = findPossibleMoves(ghosts.currentPos[ghost], ghosts.direction[ghost], ghosts.legalMoves[i], possibleMoves);
+        pickBestMove<TPersonality>(ghosts, ghost, gamestate, targetPos, possibleMoves, moveCount);
+        enterCorridor(ghosts, ghost, gamestate);
+    }
+
+    for (size_t ghost = 0; ghost < ghosts.size(); ghost++)
+        updatePos(ghosts, ghost, gamestate, deltaTime, speed);
+}
+
+template <class TPersonality>
+void CGhost::draw(const CGhostArrays &ghosts, CCanvas &canvas, CGameState::CGameMode gamemode, double alpha)
+{
+    for (size_t ghost = 0; ghost < ghosts.size(); ghost++)
+    {
+        CPos pos = CPos::interpolate(ghosts.previousPos[ghost], ghosts.currentPos[ghost], alpha);
+
+        if (gamemode != CGameState::CGameMode::powerup)
+            canvas.fillTile(pos, 1, TPersonality::R, TPersonality::G, TPersonality::B);
+        else
+            canvas.fillTile(pos, 1, 0, 0, 180);
+    }
+}
@@ -0,0 +1,129 @@
+#include "CGhostGrid.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+constexpr size_t MIN_BUCKETS = 8;                       // buckets of an empty grid
+constexpr uint64_t HASH_MULTIPLIER = 0x9e3779b97f4a7c15; // 2^64 divided by the golden ratio, spreads neighbouring tiles over the buckets
+
+void CGhostGrid::clear()
+{
+    tiles.clear();
+    next.clear();
+    previous.clear();
+    heads.clear();
+    shift = 64;
+}
+
+void CGhostGrid::add(CPos pos)
+{
+    tiles.push_back(getTile(pos));
+    next.push_back(NONE);
+    previous.push_back(NONE);
+
+    // a bucket holds a single ghost on average, the table doubles when the ghosts outgrow it
+    if (tiles.size() > heads.size())
+    {
+        size_t buckets = std::max(heads.size() * 2, MIN_BUCKETS);
+        heads.resize(buckets);
+        shift = 64 - std::countr_zero(buckets);
+        relinkAll();
+    }
+    else
+        link(tiles.size() - 1);
+}
+
+void CGhostGrid::move(size_t ghost, CPos pos)
+{
+    uint64_t tile = getTile(pos);
+    if (tile == tiles[ghost])
+        return;
+
+    unlink(ghost);
+    tiles[ghost] = tile;
+    link(ghost);
+}
+
+void CGhostGrid::rebuild(const std::vector<CPos> &positions)
+{
+    if (positions.size() != tiles.size())
+    {
+        clear();
+        for (CPos pos : positions)
+            add(pos);
+        return;
+    }
+
+    for (size_t ghost = 0; ghost < positions.size(); ghost++)
+        tiles[ghost] = getTile(positions[ghost]);
+
+    relinkAll();
+}
+
+uint32_t CGhostGrid::findFirst(CPos pos) const
+{
+    if (heads.empty())
+        return NONE;
+
+    uint64_t tile = getTile(pos);
+    return findOnTile(heads[getBucket(tile)], tile);
+}
+
+uint32_t CGhostGrid::findNext(uint32_t ghost) const
+{
+    return findOnTile(next[ghost], tiles[ghost]);
+}
+
+uint64_t CGhostGrid::getTile(CPos pos)
+{
+    // rounded like CPos::operator== rounds, a tunnel can take a coordinate to -1
+    int64_t x = static_cast<int64_t>(std::round(pos.x));
+    int64_t y = static_cast<int64_t>(std::round(pos.y));
+
+    return static_cast<uint64_t>(x) << 32 | static_cast<uint32_t>(y);
+}
+
+size_t CGhostGrid::getBucket(uint64_t tile) const
+{
+    return shift == 64 ? 0 : (tile * HASH_MULTIPLIER) >> shift;
+}
+
+uint32_t CGhostGrid::findOnTile(uint32_t ghost, uint64_t tile) const
+{
+    // other tiles can share the bucket
+    while (ghost != NONE && tiles[ghost] != tile)
+        ghost = next[ghost];
+
+    return ghost;
+}
+
+void CGhostGrid::link(uint32_t ghost)
+{
+    uint32_t &head = heads[getBucket(tiles[ghost])];
+
+    previous[ghost] = NONE;
+    next[ghost] = head;
+    if (head != NONE)
+        previous[head] = ghost;
+    head = ghost;
+}
+
+void CGhostGrid::unlink(uint32_t ghost)
+{
+    if (previous[ghost] != NONE)
+        next[previous[ghost]] = next[ghost];
+    else
+        heads[getBucket(tiles[ghost])] = next[ghost];
+
+    if (next[ghost] != NONE)
+        previous[next[ghost]] = previous[ghost];
+}
+
+void CGhostGrid::relinkAll()
+{
+    std::fill(heads.begin(), heads.end(), NONE);
+
+    for (size_t ghost = tiles.size(); ghost-- > 0;)
+        link(ghost);
+}
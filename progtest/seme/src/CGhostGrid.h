@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CPos.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** \class CGhostGrid
+The ghosts of one personality sorted into buckets by the tile they stand on, so that the ghosts on a tile are found without looking at all of them.
+
+A ghost stands on the tile its position rounds to, the same tile the collisions with the player compare (CPos::operator==). A board can have far more tiles
+than there are ghosts, so the tiles are hashed into a table of buckets sized to the number of ghosts instead. Every bucket is a doubly linked list threaded
+through arrays indexed by the ghost, so moving a ghost to another bucket takes constant time and allocates nothing. A ghost changes its tile only every few
+updates, most moves just compare the tile.
+*/
+class CGhostGrid
+{
+public:
+    static constexpr uint32_t NONE = UINT32_MAX; ///< returned when there is no further ghost on a tile
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Removes all ghosts.
+    void clear();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Adds a ghost, its index is the number of ghosts added before it. The table grows with the ghosts.
+    ///
+    /// @param [in] pos position of the ghost
+    void add(CPos pos);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Moves a ghost to a new position. It only changes buckets if the position lies on another tile.
+    ///
+    /// @param [in] ghost index of the ghost
+    /// @param [in] pos the new position
+    void move(size_t ghost, CPos pos);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Sorts all ghosts into the buckets again, e.g. after their positions were restored from a snapshot. Allocates nothing if the number of ghosts did not change.
+    ///
+    /// @param [in] positions the position of every ghost
+    void rebuild(const std::vector<CPos> &positions);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the first ghost standing on the tile of a position.
+    ///
+    /// @param [in] pos the position
+    /// @return index of the ghost, NONE if no ghost stands there
+    uint32_t findFirst(CPos pos) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the next ghost standing on the same tile as a ghost.
+    ///
+    /// @param [in] ghost index of the ghost, as returned by findFirst or findNext
+    /// @return index of the next ghost, NONE if there is none
+    uint32_t findNext(uint32_t ghost) const;
+
+private:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the tile a position rounds to, both coordinates packed into one number.
+    ///
+    /// @param [in] pos the position
+    static uint64_t getTile(CPos pos);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the bucket of a tile.
+    ///
+    /// @param [in] tile the tile, as returned by getTile
+    size_t getBucket(uint64_t tile) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the first ghost standing on a tile, starting the search at a ghost of its bucket.
+    ///
+    /// @param [in] ghost index of the ghost to start at, NONE for an empty bucket
+    /// @param [in] tile the tile
+    uint32_t findOnTile(uint32_t ghost, uint64_t tile) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Puts a ghost at the front of the bucket of its tile.
+    ///
+    /// @param [in] ghost index of the ghost
+    void link(uint32_t ghost);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Takes a ghost out of its bucket.
+    ///
+    /// @param [in] ghost index of the ghost
+    void unlink(uint32_t ghost);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Empties the buckets and links all ghosts again, in reverse order so that every bucket lists its ghosts by index.
+    void relinkAll();
+
+    std::vector<uint64_t> tiles;    ///< the tile of every ghost, see getTile
+    std::vector<uint32_t> next;     ///< the ghost after every ghost in its bucket, NONE for the last one
+    std::vector<uint32_t> previous; ///< the ghost before every ghost in its bucket, NONE for the first one
+    std::vector<uint32_t> heads;    ///< the first ghost of every bucket, a power of two of them
+    int shift = 64;                 ///< 64 minus the base 2 logarithm of the number of buckets, the hash is shifted right by it
+};
@@ -0,0 +1,109 @@
+#include "CGhostStore.h"
+#include "CGameSnapshot.h"
+
+/** \class CGhostEntry
+An entry of the registry of the personalities.
+*/
+struct CGhostEntry
+{
+    char glyph;                   ///< glyph of the personality in a config file
+    CGameMap::CMapObjects object; ///< map object of the personality
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Builds the registry from the list of the personalities.
+template <size_t... TKinds>
+constexpr std::array<CGhostEntry, sizeof...(TKinds)> makeRegistry(std::index_sequence<TKinds...>)
+{
+    return {{{std::tuple_element_t<TKinds, CGhostStore::CPersonalities>::GLYPH, std::tuple_element_t<TKinds, CGhostStore::CPersonalities>::OBJECT}...}};
+}
+
+constexpr std::array<CGhostEntry, CGhostStore::KIND_COUNT> REGISTRY = makeRegistry(std::make_index_sequence<CGhostStore::KIND_COUNT>()); // the personalities in the order of CPersonalities
+
+int CGhostStore::findKind(CGameMap::CMapObjects object)
+{
+    for (size_t kind = 0; kind < KIND_COUNT; kind++)
+        if (REGISTRY[kind].object == object)
+            return kind;
+
+    return -1;
+}
+
+bool CGhostStore::findObject(char glyph, CGameMap::CMapObjects &object)
+{
+    for (const CGhostEntry &entry : REGISTRY)
+        if (entry.glyph == glyph)
+        {
+            object = entry.object;
+            return true;
+        }
+
+    return false;
+}
+
+void CGhostStore::clear()
+{
+    for (CGhostArrays &kind : ghosts)
+        kind.clear();
+}
+
+void CGhostStore::add(size_t kind, CPos pos)
+{
+    ghosts[kind].add(pos);
+}
+
+template <size_t... TKinds>
+void CGhostStore::updateKinds(std::index_sequence<TKinds...>, CGameState &gamestate, double deltaTime)
+{
+    (CGhost::update<std::tuple_element_t<TKinds, CPersonalities>>(ghosts[TKinds], gamestate, deltaTime), ...);
+}
+
+template <size_t... TKinds>
+void CGhostStore::drawKinds(std::index_sequence<TKinds...>, CCanvas &canvas, CGameState::CGameMode gamemode, double alpha) const
+{
+    (CGhost::draw<std::tuple_element_t<TKinds, CPersonalities>>(ghosts[TKinds], canvas, gamemode, alpha), ...);
+}
+
+void CGhostStore::update(CGameState &gamestate, double deltaTime)
+{
+    updateKinds(std::make_index_sequence<KIND_COUNT>(), gamestate, deltaTime);
+}
+
+void CGhostStore::draw(CCanvas &canvas, CGameState::CGameMode gamemode, double alpha) const
+{
+    drawKinds(std::make_index_sequence<KIND_COUNT>(), canvas, gamemode, alpha);
+}
+
+size_t CGhostStore::size() const
+{
+    size_t count = 0;
+    for (const CGhostArrays &kind : ghosts)
+        count += kind.size();
+
+    return count;
+}
+
+CGhostArrays &CGhostStore::getKind(size_t kind)
+{
+    return ghosts[kind];
+}
+
+const CGhostArrays &CGhostStore::getKind(size_t kind) const
+{
+    return ghosts[kind];
+}
+
+void CGhostStore::saveState(CGameSnapshot &snapshot) const
+{
+    for (const CGhostArrays &kind : ghosts)
+        kind.saveState(snapshot);
+}
+
+bool CGhostStore::restoreState(const CGameSnapshot &snapshot, size_t &offset)
+{
+    for (CGhostArrays &kind : ghosts)
+        if (!kind.restoreState(snapshot, offset))
+            return false;
+
+    return true;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "CGhost.h"
+#include "CMax.h"
+#include "CManhattan.h"
+#include "CEuclid.h"
+
+#include <array>
+#include <tuple>
+#include <utility>
+
+/** \class CGhostStore
+All ghosts of a level, grouped by personality. Each personality keeps its ghosts in its own CGhostArrays and is updated by its own instantiation of CGhost.
+
+Ghosts do not affect each other, so updating them personality by personality gives the same result as updating them in map order.
+
+The personalities are listed in CPersonalities. The update and the drawing of every one of them is stamped out from the list at compile time,
+while the registry built from the same list matches the glyphs and objects of a map to them at runtime.
+Adding a personality takes a class like CMax, a map object for it in CGameMap and an entry in the list.
+*/
+class CGhostStore
+{
+public:
+    typedef std::tuple<CMax, CManhattan, CEuclid> CPersonalities;           ///< every ghost personality, in the order they are updated and saved
+    static constexpr size_t KIND_COUNT = std::tuple_size_v<CPersonalities>; ///< number of the personalities
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Finds the personality whose ghosts start on a map object.
+    ///
+    /// @param [in] object the map object
+    /// @return index of the personality in CPersonalities, -1 if no ghost starts on the object
+    static int findKind(CGameMap::CMapObjects object);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Finds the map object of a ghost glyph in a config file.
+    ///
+    /// @param [in] glyph the glyph
+    /// @param [out] object the map object of the personality using the glyph
+    /// @return false if no personality uses the glyph
+    static bool findObject(char glyph, CGameMap::CMapObjects &object);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Removes all ghosts.
+    void clear();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Adds a ghost.
+    ///
+    /// @param [in] kind the personality of the ghost, its index in CPersonalities
+    /// @param [in] pos initial position
+    void add(size_t kind, CPos pos);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Updates all ghosts.
+    ///
+    /// @param [in, out] gamestate a gamestate instance
+    /// @param [in] deltaTime time since last frame
+    void update(CGameState &gamestate, double deltaTime);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Draws all ghosts.
+    ///
+    /// @param [in] canvas the canvas to draw on
+    /// @param [in] gamemode the gamemode
+    /// @param [in] alpha how far the renderer is between the previous and the current update, from 0 to 1
+    void draw(CCanvas &canvas, CGameState::CGameMode gamemode, double alpha) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the number of ghosts.
+    size_t size() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the ghosts of one personality.
+    ///
+    /// @param [in] kind the personality, its index in CPersonalities
+    CGhostArrays &getKind(size_t kind);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the ghosts of one personality.
+    ///
+    /// @param [in] kind the personality, its index in CPersonalities
+    const CGhostArrays &getKind(size_t kind) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Appends the state of all ghosts to a snapshot, one personality at a time.
+    ///
+    /// @param [out] snapshot the snapshot written to
+    void saveState(CGameSnapshot &snapshot) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Reads the state of all ghosts back from a snapshot.
+    ///
+    /// @param [in] snapshot the snapshot read from
+    /// @param [in, out] offset where the state starts, moved past it
+    /// @return false if the snapshot is broken or belongs to a different level
+    bool restoreState(const CGameSnapshot &snapshot, size_t &offset);
+
+private:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Updates the ghosts of every personality with the CGhost instantiation of the personality.
+    ///
+    /// @param [in, out] gamestate a gamestate instance
+    /// @param [in] deltaTime time since last frame
+    template <size_t... TKinds>
+    void updateKinds(std::index_sequence<TKinds...>, CGameState &gamestate, double deltaTime);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Draws the ghosts of every personality with the CGhost instantiation of the personality.
+    ///
+    /// @param [in] canvas the canvas to draw on
+    /// @param [in] gamemode the gamemode
+    /// @param [in] alpha how far the renderer is between the previous and the current update, from 0 to 1
+    template <size_t... TKinds>
+    void drawKinds(std::index_sequence<TKinds...>, CCanvas &canvas, CGameState::CGameMode gamemode, double alpha) const;
+
+    std::array<CGhostArrays, KIND_COUNT> ghosts; ///< the ghosts of every personality, in the order of CPersonalities
+};
@@ -0,0 +1,49 @@
+#include "CInputQueue.h"
+
+CInputQueue::CInputQueue()
+{
+    moves.reserve(CAPACITY);
+    times.reserve(CAPACITY);
+}
+
+void CInputQueue::push(CDirection move, CTime time)
+{
+    moves.push_back(move);
+    times.push_back(time);
+}
+
+void CInputQueue::apply(CGameState &gamestate, CTime time)
+{
+    for (; first < moves.size() && times[first] <= time; first++)
+    {
+        gamestate.nextMove = moves[first];
+
+        if (!applied)
+            appliedTime = times[first];
+        applied = true;
+    }
+
+    if (first == moves.size()) // everything was applied, the space is reused
+    {
+        moves.clear();
+        times.clear();
+        first = 0;
+    }
+}
+
+void CInputQueue::clear()
+{
+    moves.clear();
+    times.clear();
+    first = 0;
+}
+
+bool CInputQueue::takeAppliedTime(CTime &time)
+{
+    if (!applied)
+        return false;
+
+    time = appliedTime;
+    applied = false;
+    return true;
+}
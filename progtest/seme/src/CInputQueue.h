@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CGameState.h"
+
+#include <chrono>
+#include <vector>
+
+/** \class CInputQueue
+Player moves waiting to be applied, each with the time the key was pressed.
+
+The game loop takes several fixed steps per frame. Every step covers a known span of real time, so a move is applied right before the first step that starts after its key press,
+instead of at the start of the frame. It also remembers when the oldest move applied since the last check was pressed, to measure input latency.
+*/
+class CInputQueue
+{
+public:
+    typedef std::chrono::steady_clock::time_point CTime; ///< a point in real time
+
+    static constexpr size_t CAPACITY = 64; ///< moves kept without reallocating. More moves in a single frame still work, the queue grows.
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Reserves the queue.
+    CInputQueue();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Adds a move. Moves have to be pushed in the order they were pressed.
+    ///
+    /// @param [in] move the move
+    /// @param [in] time when the key was pressed
+    void push(CDirection move, CTime time);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Applies the moves that were pressed until a point in time, in the order they were pressed. Called before every step with the time the step starts at.
+    ///
+    /// @param [in, out] gamestate the gamestate the moves are applied to
+    /// @param [in] time the moves pressed until this time are applied
+    void apply(CGameState &gamestate, CTime time);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Removes all moves that were not applied yet. Called when the player is not playing, so that no move is applied to the next game.
+    void clear();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns when the oldest move applied since the previous call was pressed. Called after a frame is presented, the difference to the present time is the input latency.
+    ///
+    /// @param [out] time when the move was pressed
+    /// @return false if no move was applied since the previous call
+    bool takeAppliedTime(CTime &time);
+
+private:
+    std::vector<CDirection> moves; ///< the moves, in the order they were pressed
+    std::vector<CTime> times;      ///< when every move was pressed
+    size_t first = 0;              ///< index of the first move that was not applied yet
+    bool applied = false;          ///< true if a move was applied since the last takeAppliedTime
+    CTime appliedTime;             ///< when the oldest move applied since the last takeAppliedTime was pressed
+};
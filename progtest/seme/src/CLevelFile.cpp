@@ -0,0 +1,209 @@
+#include "CLevelFile.h"
+#include "CGameState.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(std::is_trivially_copyable_v<CLevelHeader> && sizeof(CLevelHeader) == 104, "the header is read in place, its layout must not change");
+static_assert(std::is_trivially_copyable_v<CMapEntity> && sizeof(CMapEntity) == 12, "entities are read in place, their layout must not change");
+
+CLevelFile::~CLevelFile()
+{
+    munmap(const_cast<uint8_t *>(data), size);
+}
+
+bool CLevelFile::isLevelFile(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[4];
+
+    return file.read(magic, sizeof(magic)) && std::equal(magic, magic + 4, MAGIC);
+}
+
+bool CLevelFile::write(const CGameState &gamestate, const std::string &path)
+{
+    const CGameMap &gameMap = gamestate.gameMap;
+    const int width = gameMap.BOARDWIDTH;
+    const int height = gameMap.BOARDHEIGHT;
+
+    std::vector<uint8_t> tiles(static_cast<size_t>(width) * height);
+    for (int i = 0; i < height; i++)
+        for (int j = 0; j < width; j++)
+            tiles[static_cast<size_t>(i) * width + j] = gameMap.getTile(j, i);
+
+    const CMapEntity *entities = gameMap.getEntities();
+    int coinCount = std::count_if(entities, entities + gameMap.getEntityCount(), [](const CMapEntity &entity)
+                                  { return entity.object == CGameMap::C; });
+
+    CLevelHeader header = {};
+    std::copy(MAGIC, MAGIC + 4, header.magic);
+    header.version = VERSION;
+    header.playerSpeed = gamestate.PLAYER_SPEED;
+    header.initialPowerUpTime = gamestate.INITIAL_POWERUP_TIME;
+    header.powerUpTimeDecrement = gamestate.POWER_UP_TIME_DECREMENT;
+    header.timeBetweenGuardMode = gamestate.TIME_BETWEEN_GUARD_MODE;
+    header.initialGuardTime = gamestate.INITIAL_GUARD_TIME;
+    header.guardTimeDecrement = gamestate.GUARD_TIME_DECREMENT;
+    header.windowScale = gamestate.WINDOW_SCALE;
+    header.bottomPadding = gamestate.BOTTOM_PADDING;
+    header.fontSize = gamestate.FONT_SIZE;
+    header.width = width;
+    header.height = height;
+    header.coinCount = coinCount;
+    header.spawnCount = gamestate.SPAWN_COUNT;
+    header.powerUpGhostSlowdown = gamestate.POWER_UP_GHOST_SLOWDOWN;
+    header.tilesOffset = sizeof(CLevelHeader);
+    header.entitiesOffset = (header.tilesOffset + tiles.size() + alignof(CMapEntity) - 1) / alignof(CMapEntity) * alignof(CMapEntity);
+    header.entityCount = gameMap.getEntityCount();
+    header.exitsOffset = header.entitiesOffset + header.entityCount * sizeof(CMapEntity);
+
+    // written to a temporary file first, so that a reader never maps half of a level
+    std::string temporaryPath = path + ".tmp";
+    std::ofstream file(temporaryPath, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    const char padding[alignof(CMapEntity)] = {};
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(tiles.data()), tiles.size());
+    file.write(padding, header.entitiesOffset - header.tilesOffset - tiles.size());
+    file.write(reinterpret_cast<const char *>(entities), header.entityCount * sizeof(CMapEntity));
+    file.write(reinterpret_cast<const char *>(gameMap.graph.getTable()), CMazeGraph::getTableSize(width, height));
+    file.close();
+
+    if (!file || std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+std::shared_ptr<const CLevelFile> CLevelFile::load(const std::string &path)
+{
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+        throw std::invalid_argument("unable to open level file");
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(CLevelHeader))
+    {
+        close(descriptor);
+        throw std::invalid_argument("level file too short");
+    }
+
+    size_t size = status.st_size;
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor); // the mapping stays valid without the descriptor
+
+    if (data == MAP_FAILED)
+        throw std::invalid_argument("unable to map level file");
+
+    std::shared_ptr<const CLevelFile> level(new CLevelFile(data, size));
+    level->validate();
+    return level;
+}
+
+void CLevelFile::validate() const
+{
+    const CLevelHeader &header = getHeader();
+
+    if (!std::equal(header.magic, header.magic + 4, MAGIC))
+        throw std::invalid_argument("not a level file");
+    if (header.version != VERSION)
+        throw std::invalid_argument("level file of another version, compile it again");
+    if (header.width < 1 || header.height < 1 || header.width > CGameMap::MAX_SIZE || header.height > CGameMap::MAX_SIZE)
+        throw std::invalid_argument("level board size out of range");
+    if (header.spawnCount < 1 || header.spawnCount > CGameState::MAX_SPAWN_COUNT)
+        throw std::invalid_argument("level spawn count out of range");
+
+    // every section has to fit into the file, the sizes are checked by subtraction so that they cannot overflow
+    uint64_t tilesSize = static_cast<uint64_t>(header.width) * header.height;
+    if (header.tilesOffset > size || tilesSize > size - header.tilesOffset)
+        throw std::invalid_argument("level tiles out of the file");
+    if (header.entitiesOffset % alignof(CMapEntity) != 0 || header.entitiesOffset > size ||
+        header.entityCount > (size - header.entitiesOffset) / sizeof(CMapEntity))
+        throw std::invalid_argument("level entities out of the file");
+    if (header.exitsOffset > size || CMazeGraph::getTableSize(header.width, header.height) > size - header.exitsOffset)
+        throw std::invalid_argument("level maze graph out of the file");
+
+    // the tiles are cast to CGameMap::CMapObjects and the entities index the collectible grid, so nothing broken may get past this point
+    const uint8_t *tiles = getTiles();
+    uint64_t entityTiles = 0;
+    for (uint64_t i = 0; i < tilesSize; i++)
+    {
+        if (tiles[i] > CGameMap::O)
+            throw std::invalid_argument("level tile out of range");
+        if (tiles[i] != CGameMap::W && tiles[i] != CGameMap::O)
+            entityTiles++;
+    }
+
+    // the entities list every tile holding a collectible or a start position exactly once, row by row
+    if (header.entityCount != entityTiles)
+        throw std::invalid_argument("level entities do not match the tiles");
+
+    const CMapEntity *entities = getEntities();
+    uint64_t previous = 0;
+    int coinCount = 0;
+    for (uint64_t i = 0; i < header.entityCount; i++)
+    {
+        const CMapEntity &entity = entities[i];
+        if (entity.x < 0 || entity.y < 0 || entity.x >= header.width || entity.y >= header.height)
+            throw std::invalid_argument("level entity out of the board");
+
+        uint64_t index = static_cast<uint64_t>(entity.y) * header.width + entity.x;
+        if (entity.object != tiles[index] || (i > 0 && index <= previous))
+            throw std::invalid_argument("level entities do not match the tiles");
+
+        previous = index;
+        if (entity.object == CGameMap::C)
+            coinCount++;
+    }
+
+    if (coinCount != header.coinCount)
+        throw std::invalid_argument("level coin count does not match the tiles");
+
+    // the maze graph is used as it is stored, it has to be the one the tiles compile to
+    const int width = header.width;
+    const int height = header.height;
+    auto isWall = [tiles, width, height](int x, int y)
+    { return x < 0 || y < 0 || x >= width || y >= height || tiles[static_cast<size_t>(y) * width + x] == CGameMap::W; };
+
+    const uint8_t *exits = getExits();
+    const int columns = width + 2 * CMazeGraph::PADDING;
+    for (int y = -CMazeGraph::PADDING; y < height + CMazeGraph::PADDING; y++)
+        for (int x = -CMazeGraph::PADDING; x < width + CMazeGraph::PADDING; x++)
+            if (exits[static_cast<size_t>(y + CMazeGraph::PADDING) * columns + x + CMazeGraph::PADDING] != CMazeGraph::compileTile(x, y, width, height, isWall))
+                throw std::invalid_argument("level maze graph does not match the tiles");
+}
+
+const CLevelHeader &CLevelFile::getHeader() const
+{
+    return *reinterpret_cast<const CLevelHeader *>(data);
+}
+
+const uint8_t *CLevelFile::getTiles() const
+{
+    return data + getHeader().tilesOffset;
+}
+
+const CMapEntity *CLevelFile::getEntities() const
+{
+    return reinterpret_cast<const CMapEntity *>(data + getHeader().entitiesOffset);
+}
+
+const uint8_t *CLevelFile::getExits() const
+{
+    return data + getHeader().exitsOffset;
+}
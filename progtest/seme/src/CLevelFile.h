@@ -0,0 +1,113 @@
+#pragma once
+
+#include "CGameMap.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct CGameState;
+
+/** \class CLevelHeader
+The header at the start of a compiled level file. The layout is fixed, the header is read in place.
+*/
+struct CLevelHeader
+{
+    char magic[4];                ///< file signature, CLevelFile::MAGIC
+    uint32_t version;             ///< CLevelFile::VERSION of the compiler that wrote the file
+    int32_t playerSpeed;          ///< PLAYER_SPEED
+    int32_t initialPowerUpTime;   ///< INITIAL_POWERUP_TIME
+    int32_t powerUpTimeDecrement; ///< POWER_UP_TIME_DECREMENT
+    int32_t timeBetweenGuardMode; ///< TIME_BETWEEN_GUARD_MODE
+    int32_t initialGuardTime;     ///< INITIAL_GUARD_TIME
+    int32_t guardTimeDecrement;   ///< GUARD_TIME_DECREMENT
+    int32_t windowScale;          ///< WINDOW_SCALE
+    int32_t bottomPadding;        ///< BOTTOM_PADDING
+    int32_t fontSize;             ///< FONT_SIZE
+    int32_t width;                ///< width of the board
+    int32_t height;               ///< height of the board
+    int32_t coinCount;            ///< number of coins on the board
+    int32_t spawnCount;           ///< SPAWN_COUNT
+    int32_t reserved;             ///< always 0, keeps the following fields aligned
+    double powerUpGhostSlowdown;  ///< POWER_UP_GHOST_SLOWDOWN
+    uint64_t tilesOffset;         ///< offset of the tiles in the file, width * height bytes row by row
+    uint64_t entitiesOffset;      ///< offset of the entities in the file, aligned for CMapEntity
+    uint64_t entityCount;         ///< number of the entities
+    uint64_t exitsOffset;         ///< offset of the maze graph table in the file, see CMazeGraph::getTable
+};
+
+/** \class CLevelFile
+A level compiled ahead of time by svobov25-compile: the config constants, the tiles, the entities (collectibles and start positions) and the table of the maze graph.
+
+Loading maps the file into memory. The sections are checked to lie within the file and to agree with the tiles, and then used in place, nothing is parsed.
+The text config stays the source format, a level file is compiled from it.
+*/
+class CLevelFile
+{
+public:
+    static constexpr char MAGIC[4] = {'P', 'M', 'L', 'V'}; ///< file signature of level files
+    static constexpr uint32_t VERSION = 2;                 ///< bumped whenever the file layout or the content of the compiled tables changes
+
+    CLevelFile(const CLevelFile &) = delete;
+    CLevelFile &operator=(const CLevelFile &) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Unmaps the file
+    ~CLevelFile();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Checks if a file starts with the signature of a level file.
+    ///
+    /// @param [in] path path to the file
+    static bool isLevelFile(const std::string &path);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Compiles the config constants and the board of a gamestate into a level file.
+    ///
+    /// @param [in] gamestate a gamestate with the config already loaded
+    /// @param [in] path path to the level file
+    /// @return true if the file was written
+    static bool write(const CGameState &gamestate, const std::string &path);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Maps a level file into memory.
+    ///
+    /// @param [in] path path to the level file
+    /// @throws std::invalid_argument if the file cannot be mapped, was written by another version, its sections do not fit into it or do not agree with the tiles
+    static std::shared_ptr<const CLevelFile> load(const std::string &path);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the header of the file.
+    const CLevelHeader &getHeader() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the tiles of the board, row by row.
+    const uint8_t *getTiles() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the entities of the board, row by row.
+    const CMapEntity *getEntities() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the table of the maze graph.
+    const uint8_t *getExits() const;
+
+private:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Constructor that takes over a mapping
+    ///
+    /// @param [in] data start of the mapping
+    /// @param [in] size size of the mapping in bytes
+    CLevelFile(const void *data, size_t size) : data(static_cast<const uint8_t *>(data)), size(size){};
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Checks that the header is valid and that all sections lie within the file. Every tile has to be a CGameMap::CMapObjects value,
+    /// and the entities, the coin count and the maze graph table have to be exactly what the tiles compile to.
+    ///
+    /// @throws std::invalid_argument if they do not
+    void validate() const;
+
+    const uint8_t *data; ///< the mapped file
+    size_t size;         ///< size of the file in bytes
+};
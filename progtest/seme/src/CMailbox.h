@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+/** \class CMailbox
+Messages posted by one thread and taken by another one in the order they were posted, e.g. the key presses the window passes on to the simulation thread.
+
+The receiver takes all waiting messages at once by swapping its vector with the one of the mailbox, so once both vectors have grown to the most messages posted
+between two takes, neither posting nor taking allocates. The receiver can sleep until a message arrives, the mailbox is closed or a deadline passes.
+*/
+template <class T>
+class CMailbox
+{
+public:
+    typedef std::chrono::steady_clock::time_point CTime; ///< a point in real time
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Reserves room for a number of messages.
+    ///
+    /// @param [in] capacity messages posted between two takes without reallocating, more still work
+    CMailbox(size_t capacity) { messages.reserve(capacity); }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Posts a message and wakes the receiver up.
+    ///
+    /// @param [in] message the message
+    void post(const T &message)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            messages.push_back(message);
+        }
+        wakeup.notify_one();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Closes the mailbox and wakes the receiver up. Called when the receiver should stop.
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        wakeup.notify_one();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Waits until a message arrives or the mailbox is closed, then takes all waiting messages.
+    ///
+    /// @param [in, out] taken the messages are appended to it if it is not empty, otherwise it is swapped with the vector of the mailbox
+    /// @return false if the mailbox was closed
+    bool wait(std::vector<T> &taken)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        wakeup.wait(lock, [this]()
+                    { return closed || !messages.empty(); });
+        moveMessages(taken);
+        return !closed;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Waits until a message arrives, the mailbox is closed or a point in time passes, then takes all waiting messages.
+    ///
+    /// @param [in, out] taken the messages are appended to it if it is not empty, otherwise it is swapped with the vector of the mailbox
+    /// @param [in] deadline the latest time to return at
+    /// @return false if the mailbox was closed
+    bool waitUntil(std::vector<T> &taken, CTime deadline)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        wakeup.wait_until(lock, deadline, [this]()
+                          { return closed || !messages.empty(); });
+        moveMessages(taken);
+        return !closed;
+    }
+
+private:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Moves the waiting messages to the receiver's vector. Called with the mutex locked.
+    ///
+    /// @param [in, out] taken the receiver's vector
+    void moveMessages(std::vector<T> &taken)
+    {
+        if (taken.empty())
+            taken.swap(messages);
+        else
+        {
+            taken.insert(taken.end(), messages.begin(), messages.end());
+            messages.clear();
+        }
+    }
+
+    std::mutex mutex;               ///< guards the messages and closed
+    std::condition_variable wakeup; ///< notified when a message is posted or the mailbox is closed
+    std::vector<T> messages;        ///< the messages not taken yet, in the order they were posted
+    bool closed = false;            ///< true once close was called
+};
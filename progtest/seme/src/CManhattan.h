@@ -2,35 +2,39 @@
 
 #include "CGhost.h"
 
+#include <cmath>
+
 /** \class CManhattan
-A ghost class that will use the manhattan vector norm for pathfinding
+A ghost personality that will use the manhattan vector norm for pathfinding. Passed to CGhost as a template parameter, everything is defined inline so that it is compiled into the ghosts' decisions.
 */
-class CManhattan : public CGhost
+class CManhattan
 {
 public:
-    ////////////////////////////////////////////////////////////////////////////////
-    /// Constructor that creates Manhattan at the specified position.
-    ///
-    /// @param [in] pos initial position
-    CManhattan(CPos pos) : CGhost(pos){};
-
-    ////////////////////////////////////////////////////////////////////////////////
-    /// Draws Manhattan on the screen according to his current position.
-    ///
-    /// @param [in] renderer a pointer to the SDL_Renderer
-    /// @param [in] gamestate a gamestate instance
-    virtual void draw(SDL_Renderer *renderer, CGameState &gamestate) override;
+    static constexpr int R = 60;                                 ///< red component of Manhattan's color
+    static constexpr int G = 150;                                ///< green component of Manhattan's color
+    static constexpr int B = 10;                                 ///< blue component of Manhattan's color
+    static constexpr char GLYPH = 't';                           ///< the glyph of Manhattan's start position in the map
+    static constexpr CGameMap::CMapObjects OBJECT = CGameMap::t; ///< the map object of Manhattan's start position
 
-protected:
     ////////////////////////////////////////////////////////////////////////////////
     /// Returns the Manhattan norm of a position that is interpreted as a vector
     ///
     /// @param[in] position a 2-d vector
-    virtual double getNorm(CPos position) override;
+    static double getNorm(CPos position);
 
     ////////////////////////////////////////////////////////////////////////////////
     /// Returns the position Manhattan wants to take when he's in guard mode.
     ///
     /// @param[in] gamestate a gamestate instance
-    virtual CPos getGuardPos(CGameState &gamestate) override;
-};
\ No newline at end of file
+    static CPos getGuardPos(const CGameState &gamestate);
+};
+
+inline double CManhattan::getNorm(CPos position)
+{
+    return std::abs(position.x) + std::abs(position.y);
+}
+
+inline CPos CManhattan::getGuardPos(const CGameState &gamestate)
+{
+    return CPos(0, gamestate.gameMap.BOARDHEIGHT);
+}
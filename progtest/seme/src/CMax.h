@@ -2,35 +2,39 @@
 
 #include "CGhost.h"
 
+#include <cmath>
+
 /** \class CMax
-A ghost class that will use the maximum vector norm for pathfinding
+A ghost personality that will use the maximum vector norm for pathfinding. Passed to CGhost as a template parameter, everything is defined inline so that it is compiled into the ghosts' decisions.
 */
-class CMax : public CGhost
+class CMax
 {
 public:
-    ////////////////////////////////////////////////////////////////////////////////
-    /// Constructor that creates Max at the specified position.
-    ///
-    /// @param [in] pos initial position
-    CMax(CPos pos) : CGhost(pos){};
-
-    ////////////////////////////////////////////////////////////////////////////////
-    /// Draws Max on the screen according to his current position.
-    ///
-    /// @param [in] renderer a pointer to the SDL_Renderer
-    /// @param [in] gamestate a gamestate instance
-    virtual void draw(SDL_Renderer *renderer, CGameState &gamestate) override;
+    static constexpr int R = 150;                                ///< red component of Max's color
+    static constexpr int G = 60;                                 ///< green component of Max's color
+    static constexpr int B = 10;                                 ///< blue component of Max's color
+    static constexpr char GLYPH = 'm';                           ///< the glyph of Max's start position in the map
+    static constexpr CGameMap::CMapObjects OBJECT = CGameMap::m; ///< the map object of Max's start position
 
-protected:
     ////////////////////////////////////////////////////////////////////////////////
     /// Returns the max norm of a position that is interpreted as a vector
     ///
     /// @param[in] position a 2-d vector
-    virtual double getNorm(CPos position) override;
+    static double getNorm(CPos position);
 
     ////////////////////////////////////////////////////////////////////////////////
     /// Returns the position Max wants to take when he's in guard mode.
     ///
     /// @param[in] gamestate a gamestate instance
-    virtual CPos getGuardPos(CGameState &gamestate) override;
-};
\ No newline at end of file
+    static CPos getGuardPos(const CGameState &gamestate);
+};
+
+inline double CMax::getNorm(CPos position)
+{
+    return std::abs(position.x) < std::abs(position.y) ? std::abs(position.y) : std::abs(position.x);
+}
+
+inline CPos CMax::getGuardPos(const CGameState &gamestate)
+{
+    return CPos(gamestate.gameMap.BOARDWIDTH, gamestate.gameMap.BOARDHEIGHT);
+}
@@ -0,0 +1,275 @@
+#include "CMazeGraph.h"
+#include "CGameMap.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+constexpr CDirection DIRECTIONS[4] = {CDirection::up, CDirection::down, CDirection::left, CDirection::right}; // in the order of their bits
+constexpr int STEP_X[4] = {0, 0, -1, 1};                                                                     // x coordinate change of a step in every direction
+constexpr int STEP_Y[4] = {-1, 1, 0, 0};                                                                     // y coordinate change of a step in every direction
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+static_assert(sizeof(CPos) == 2 * sizeof(double), "the coordinates of a CPos are loaded into a single register");
+
+////////////////////////////////////////////////////////////////////////////////
+/// Narrows the results of two comparisons of two doubles each to four 32-bit lanes, in the order of the positions.
+///
+/// @param [in] low the comparison of the first two positions
+/// @param [in] high the comparison of the last two positions
+static __m128i narrowMasks(__m128d low, __m128d high)
+{
+    return _mm_castps_si128(_mm_shuffle_ps(_mm_castpd_ps(low), _mm_castpd_ps(high), _MM_SHUFFLE(2, 0, 2, 0)));
+}
+#endif
+
+uint8_t CMazeGraph::getBit(CDirection direction)
+{
+    switch (direction)
+    {
+    case CDirection::up:
+        return 1;
+    case CDirection::down:
+        return 2;
+    case CDirection::left:
+        return 4;
+    case CDirection::right:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+void CMazeGraph::build(const CGameMap &map)
+{
+    int width = map.BOARDWIDTH;
+    int height = map.BOARDHEIGHT;
+    columns = width + 2 * PADDING;
+    rows = height + 2 * PADDING;
+    tiles.assign(columns * rows, 0);
+    attached = nullptr;
+
+    // getTile returns walls outside of the board
+    auto isWall = [&map](int x, int y)
+    { return map.getTile(x, y) == CGameMap::W; };
+
+    for (int y = -PADDING; y < height + PADDING; y++)
+        for (int x = -PADDING; x < width + PADDING; x++)
+            tiles[(y + PADDING) * columns + x + PADDING] = compileTile(x, y, width, height, isWall);
+
+    buildEdges(width, height);
+}
+
+void CMazeGraph::attach(const uint8_t *table, int width, int height)
+{
+    columns = width + 2 * PADDING;
+    rows = height + 2 * PADDING;
+    tiles.clear();
+    attached = table;
+    buildEdges(width, height);
+}
+
+void CMazeGraph::buildEdges(int boardWidth, int boardHeight)
+{
+    width = boardWidth;
+    height = boardHeight;
+
+    size_t tileCount = static_cast<size_t>(width) * height;
+    nodeBits.assign((tileCount + 63) / 64, 0);
+    nodeRanks.assign(nodeBits.size(), 0);
+
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            if (getTile(x, y) & NODE)
+            {
+                size_t index = static_cast<size_t>(y) * width + x;
+                nodeBits[index / 64] |= 1ull << (index % 64);
+            }
+
+    uint32_t nodeCount = 0;
+    for (size_t word = 0; word < nodeBits.size(); word++)
+    {
+        nodeRanks[word] = nodeCount;
+        nodeCount += std::popcount(nodeBits[word]);
+    }
+
+    // every corridor is walked once from each of its ends. The border tiles are nodes, so a walk ends on the board
+    edgeLengths.assign(static_cast<size_t>(nodeCount) * 4, 0);
+    uint32_t node = 0;
+
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+        {
+            uint8_t exits = getTile(x, y);
+            if (!(exits & NODE))
+                continue;
+
+            for (int i = 0; i < 4; i++)
+            {
+                if (!(exits & getBit(DIRECTIONS[i])))
+                    continue;
+
+                int length = 1;
+                int endX = x + STEP_X[i];
+                int endY = y + STEP_Y[i];
+                while (endX >= 0 && endY >= 0 && endX < width && endY < height && !(getTile(endX, endY) & NODE))
+                {
+                    endX += STEP_X[i];
+                    endY += STEP_Y[i];
+                    length++;
+                }
+
+                // a tunnel leads out of the board, it is no edge
+                if (endX >= 0 && endY >= 0 && endX < width && endY < height)
+                    edgeLengths[node * 4 + i] = length;
+            }
+
+            node++;
+        }
+}
+
+const uint8_t *CMazeGraph::getTable() const
+{
+    return attached ? attached : tiles.data();
+}
+
+size_t CMazeGraph::getTableSize(int width, int height)
+{
+    return static_cast<size_t>(width + 2 * PADDING) * (height + 2 * PADDING);
+}
+
+uint8_t CMazeGraph::getTile(int x, int y) const
+{
+    // positions in the tunnels are at most a tile outside of the board, clamping only guards against broken positions
+    x = std::clamp(x + PADDING, 0, columns - 1);
+    y = std::clamp(y + PADDING, 0, rows - 1);
+    return getTable()[y * columns + x];
+}
+
+uint8_t CMazeGraph::getExits(int x, int y) const
+{
+    return getTile(x, y) & ~NODE;
+}
+
+bool CMazeGraph::isNode(int x, int y) const
+{
+    return x >= 0 && y >= 0 && x < width && y < height && (getTile(x, y) & NODE);
+}
+
+bool CMazeGraph::getEdge(int x, int y, CDirection direction, CEdge &edge) const
+{
+    if (direction == CDirection::none || !isNode(x, y))
+        return false;
+
+    size_t index = static_cast<size_t>(y) * width + x;
+    size_t word = index / 64;
+    uint32_t rank = nodeRanks[word] + std::popcount(nodeBits[word] & ((1ull << (index % 64)) - 1));
+    int i = std::countr_zero(getBit(direction));
+
+    int length = edgeLengths[rank * 4 + i];
+    if (length == 0)
+        return false;
+
+    edge = {x + STEP_X[i] * length, y + STEP_Y[i] * length, length};
+    return true;
+}
+
+uint8_t CMazeGraph::combine(int x, int y, bool nearX, bool nearY, bool farX, bool farY) const
+{
+    uint8_t exits = getTile(x, y);
+    uint8_t legal = 0;
+
+    if (!farX && ((exits & getBit(CDirection::up)) || !nearY))
+        legal |= getBit(CDirection::up);
+    if (!farX && (exits & getBit(CDirection::down)))
+        legal |= getBit(CDirection::down);
+    if (!farY && ((exits & getBit(CDirection::left)) || !nearX))
+        legal |= getBit(CDirection::left);
+    if (!farY && (exits & getBit(CDirection::right)))
+        legal |= getBit(CDirection::right);
+
+    return legal;
+}
+
+uint8_t CMazeGraph::getLegalMoves(CPos pos) const
+{
+    std::pair<int, int> intPos = pos.getIntPos();
+    double fractionX = pos.x - intPos.first;
+    double fractionY = pos.y - intPos.second;
+
+    return combine(intPos.first, intPos.second,
+                   fractionX < THRESHOLD, fractionY < THRESHOLD,
+                   fractionX > THRESHOLD, fractionY > THRESHOLD);
+}
+
+void CMazeGraph::getLegalMoves(const CPos *positions, uint8_t *masks, size_t count) const
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128d threshold = _mm_set1_pd(THRESHOLD);
+    const __m128i upBit = _mm_set1_epi32(getBit(CDirection::up));
+    const __m128i leftBit = _mm_set1_epi32(getBit(CDirection::left));
+    const __m128i verticalBits = _mm_set1_epi32(getBit(CDirection::up) | getBit(CDirection::down));
+    const __m128i horizontalBits = _mm_set1_epi32(getBit(CDirection::left) | getBit(CDirection::right));
+    alignas(16) int32_t tileX[4];
+    alignas(16) int32_t tileY[4];
+
+    for (; i + 4 <= count; i += 4)
+    {
+        // the positions are stored x, y, x, y..., the x and the y coordinates of two positions are swapped into a register each
+        __m128d first = _mm_loadu_pd(&positions[i].x);
+        __m128d second = _mm_loadu_pd(&positions[i + 1].x);
+        __m128d third = _mm_loadu_pd(&positions[i + 2].x);
+        __m128d fourth = _mm_loadu_pd(&positions[i + 3].x);
+        __m128d lowX = _mm_unpacklo_pd(first, second);
+        __m128d lowY = _mm_unpackhi_pd(first, second);
+        __m128d highX = _mm_unpacklo_pd(third, fourth);
+        __m128d highY = _mm_unpackhi_pd(third, fourth);
+
+        // truncated toward zero, like CPos::getIntPos
+        __m128i lowTileX = _mm_cvttpd_epi32(lowX);
+        __m128i lowTileY = _mm_cvttpd_epi32(lowY);
+        __m128i highTileX = _mm_cvttpd_epi32(highX);
+        __m128i highTileY = _mm_cvttpd_epi32(highY);
+        __m128d lowFractionX = _mm_sub_pd(lowX, _mm_cvtepi32_pd(lowTileX));
+        __m128d lowFractionY = _mm_sub_pd(lowY, _mm_cvtepi32_pd(lowTileY));
+        __m128d highFractionX = _mm_sub_pd(highX, _mm_cvtepi32_pd(highTileX));
+        __m128d highFractionY = _mm_sub_pd(highY, _mm_cvtepi32_pd(highTileY));
+
+        __m128i nearX = narrowMasks(_mm_cmplt_pd(lowFractionX, threshold), _mm_cmplt_pd(highFractionX, threshold));
+        __m128i nearY = narrowMasks(_mm_cmplt_pd(lowFractionY, threshold), _mm_cmplt_pd(highFractionY, threshold));
+        __m128i farX = narrowMasks(_mm_cmpgt_pd(lowFractionX, threshold), _mm_cmpgt_pd(highFractionX, threshold));
+        __m128i farY = narrowMasks(_mm_cmpgt_pd(lowFractionY, threshold), _mm_cmpgt_pd(highFractionY, threshold));
+
+        _mm_store_si128(reinterpret_cast<__m128i *>(tileX), _mm_unpacklo_epi64(lowTileX, highTileX));
+        _mm_store_si128(reinterpret_cast<__m128i *>(tileY), _mm_unpacklo_epi64(lowTileY, highTileY));
+        __m128i exits = _mm_setr_epi32(getTile(tileX[0], tileY[0]), getTile(tileX[1], tileY[1]),
+                                       getTile(tileX[2], tileY[2]), getTile(tileX[3], tileY[3]));
+
+        // combine as bit operations: up and left are also legal away from the center (not near), and nothing leaves its axis when far from the center
+        __m128i vertical = _mm_andnot_si128(farX, _mm_and_si128(_mm_or_si128(exits, _mm_andnot_si128(nearY, upBit)), verticalBits));
+        __m128i horizontal = _mm_andnot_si128(farY, _mm_and_si128(_mm_or_si128(exits, _mm_andnot_si128(nearX, leftBit)), horizontalBits));
+        __m128i legal = _mm_or_si128(vertical, horizontal);
+
+        // every lane holds at most 15, it narrows to a byte without saturating
+        legal = _mm_packs_epi32(legal, legal);
+        legal = _mm_packus_epi16(legal, legal);
+        int32_t packed = _mm_cvtsi128_si32(legal);
+        std::memcpy(masks + i, &packed, sizeof(packed));
+    }
+#endif
+
+    for (; i < count; i++)
+        masks[i] = getLegalMoves(positions[i]);
+}
+
+bool CMazeGraph::isLegal(CDirection move, CPos pos) const
+{
+    if (move == CDirection::none)
+        return true;
+
+    return getLegalMoves(pos) & getBit(move);
+}
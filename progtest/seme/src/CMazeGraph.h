@@ -0,0 +1,198 @@
+#pragma once
+
+#include "CPos.h"
+#include "CDirection.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct CGameMap;
+
+/** \class CMazeGraph
+The board compiled into a movement table and a graph of the maze. Every tile of the table has a 4-bit mask of the directions leading out of it (see getBit)
+and a flag telling if it is a node of the graph.
+
+A tile with exactly the two exits up and down, or left and right, is the inside of a straight corridor: a ghost moving through it has nowhere to go
+but forward. Every other tile that is not a wall is a node: the junctions, but also the corners and the dead ends, where a ghost turns, and all tiles
+on the border of the board, where the tunnels start. A ghost that has just turned a corner still sees the way it came from, so it may decide there as well.
+The edges of the graph are the corridors between two nodes. They are straight, an edge is left in the direction it was entered.
+
+Every node stores its four edges (the length of the corridor in each direction, zero if there is none). The nodes are found by their rank in a bitset of the tiles,
+so the edges take memory only for the nodes and not for the tiles of the corridors.
+
+Moving out of the board through the first and the last column and row is never blocked, it leads through a tunnel to the other side.
+The table is padded with two tiles on every side, so the tiles of the tunnels (just outside of the board) have their masks too. Tiles outside of the board
+count as walls, a ghost in a tunnel can only move along it.
+A table compiled in advance (stored in a level file) can be attached and is then used in place.
+*/
+class CMazeGraph
+{
+public:
+    static constexpr int PADDING = 2;         ///< tiles around the board in the table
+    static constexpr uint8_t NODE = 16;       ///< the flag of a node tile, next to the exit bits
+    static constexpr double THRESHOLD = 0.05; ///< Experimentaly set. Needs to be low enough so that the position is close to a whole number and high enough that we do not skip it between two frames.
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the bit of a direction in the exit masks and in the masks returned by getLegalMoves.
+    ///
+    /// @param [in] direction the direction, none has no bit
+    static uint8_t getBit(CDirection direction);
+
+    /** \class CEdge
+    A corridor leading from a node to the next one.
+    */
+    struct CEdge
+    {
+        int x;      ///< x coordinate of the node at the end of the corridor
+        int y;      ///< y coordinate of the node at the end of the corridor
+        int length; ///< number of steps from tile to tile between the two nodes
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Compiles the exit masks, the nodes and the edges of a board, straight from its tiles.
+    ///
+    /// @param [in] map the board
+    void build(const CGameMap &map);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Compiles the table entry of a tile: its exits and its NODE flag. Used by build, and to check a table compiled in advance against its tiles.
+    ///
+    /// @param [in] x x coordinate of the tile, up to PADDING tiles outside of the board
+    /// @param [in] y y coordinate of the tile, up to PADDING tiles outside of the board
+    /// @param [in] width width of the board
+    /// @param [in] height height of the board
+    /// @param [in] isWall called with the coordinates of a tile, returns true for a wall and for every tile outside of the board
+    template <class TIsWall>
+    static uint8_t compileTile(int x, int y, int width, int height, TIsWall isWall);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Uses a table built in advance, in place. It is not copied, so it has to outlive the graph and all of its copies. The edges are found from the table.
+    ///
+    /// @param [in] table getTableSize(width, height) entries, as returned by getTable
+    /// @param [in] width width of the board
+    /// @param [in] height height of the board
+    void attach(const uint8_t *table, int width, int height);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the table, row by row, with the padding. Every entry holds the exits of a tile and its NODE flag.
+    const uint8_t *getTable() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the number of entries of the table of a board.
+    ///
+    /// @param [in] width width of the board
+    /// @param [in] height height of the board
+    static size_t getTableSize(int width, int height);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the directions leading out of a tile, one bit per direction.
+    ///
+    /// @param [in] x x coordinate of the tile
+    /// @param [in] y y coordinate of the tile
+    uint8_t getExits(int x, int y) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Checks if a tile is a node of the graph.
+    ///
+    /// @param [in] x x coordinate of the tile
+    /// @param [in] y y coordinate of the tile
+    bool isNode(int x, int y) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Finds the corridor leading from a node in a direction.
+    ///
+    /// @param [in] x x coordinate of the node
+    /// @param [in] y y coordinate of the node
+    /// @param [in] direction the direction the corridor leads to
+    /// @param [out] edge the corridor, left unchanged if there is none
+    /// @return false if the tile is not a node, or if no corridor leads from it in the direction (a wall, or a tunnel out of the board)
+    bool getEdge(int x, int y, CDirection direction, CEdge &edge) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the moves that are legal from a position, one bit per direction.
+    ///
+    /// A move is legal when the position is close enough to the center of a tile on the other axis and the tile has an exit in its direction.
+    /// Moves up and left stay legal until the position is close to the center of the tile before the wall.
+    ///
+    /// @param [in] pos the position
+    uint8_t getLegalMoves(CPos pos) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the legal moves of many positions at once, the same masks getLegalMoves returns for every position.
+    ///
+    /// With SSE2, four positions are handled at once: their coordinates are truncated, compared to THRESHOLD and combined with the exit masks
+    /// in vector registers. Only the exit masks are read one at a time, SSE2 cannot gather them.
+    ///
+    /// @param [in] positions the positions
+    /// @param [out] masks the legal moves of every position, as returned by getLegalMoves
+    /// @param [in] count number of the positions
+    void getLegalMoves(const CPos *positions, uint8_t *masks, size_t count) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Checks if a move from a position is legal. No move (none) is always legal.
+    ///
+    /// @param [in] move the move
+    /// @param [in] pos the position
+    bool isLegal(CDirection move, CPos pos) const;
+
+private:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the entry of a tile, tiles further out than the padding share the entries of the border of the table.
+    ///
+    /// @param [in] x x coordinate of the tile
+    /// @param [in] y y coordinate of the tile
+    uint8_t getTile(int x, int y) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Combines the exits of a tile with the position within the tile. The vector version in getLegalMoves computes the same bits.
+    ///
+    /// @param [in] x x coordinate of the tile, truncated toward zero
+    /// @param [in] y y coordinate of the tile, truncated toward zero
+    /// @param [in] nearX true if the position is less than THRESHOLD right of the tile's x coordinate
+    /// @param [in] nearY true if the position is less than THRESHOLD below the tile's y coordinate
+    /// @param [in] farX true if the position is more than THRESHOLD right of the tile's x coordinate
+    /// @param [in] farY true if the position is more than THRESHOLD below the tile's y coordinate
+    uint8_t combine(int x, int y, bool nearX, bool nearY, bool farX, bool farY) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Sets the size of the board and finds the nodes and the edges in the table.
+    ///
+    /// @param [in] width width of the board
+    /// @param [in] height height of the board
+    void buildEdges(int width, int height);
+
+    std::vector<uint8_t> tiles;        ///< the exits and the node flag of the tile (x, y) are stored at (y + PADDING) * columns + x + PADDING
+    const uint8_t *attached = nullptr; ///< an attached table used instead of tiles, null if there is none
+    int columns = 0;                   ///< width of the table, including the padding
+    int rows = 0;                      ///< height of the table, including the padding
+    int width = 0;                     ///< width of the board
+    int height = 0;                    ///< height of the board
+    std::vector<uint64_t> nodeBits;    ///< bit y * width + x is set if the tile (x, y) is a node
+    std::vector<uint32_t> nodeRanks;   ///< the number of nodes before every word of nodeBits, the rank of a node is its index in edgeLengths
+    std::vector<uint16_t> edgeLengths; ///< the lengths of the four edges of every node, in the order of the direction bits, zero if there is no edge
+};
+
+template <class TIsWall>
+uint8_t CMazeGraph::compileTile(int x, int y, int width, int height, TIsWall isWall)
+{
+    // the walls next to the first and the last column and row are not tested, the tunnels lead through them
+    uint8_t exits = 0;
+    if (!(y > 0 && isWall(x, y - 1)))
+        exits |= getBit(CDirection::up);
+    if (!(y < height - 1 && isWall(x, y + 1)))
+        exits |= getBit(CDirection::down);
+    if (!(x > 0 && isWall(x - 1, y)))
+        exits |= getBit(CDirection::left);
+    if (!(x < width - 1 && isWall(x + 1, y)))
+        exits |= getBit(CDirection::right);
+
+    // a straight corridor tile is neither on the border nor anything but a way through
+    bool border = x == 0 || y == 0 || x == width - 1 || y == height - 1;
+    bool straight = exits == (getBit(CDirection::up) | getBit(CDirection::down)) ||
+                    exits == (getBit(CDirection::left) | getBit(CDirection::right));
+    if (!isWall(x, y) && (border || !straight))
+        exits |= NODE;
+
+    return exits;
+}
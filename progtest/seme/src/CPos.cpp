@@ -15,4 +15,12 @@ bool CPos::operator==(const CPos &rhs) const
 CPos CPos::operator-(const CPos &rhs)
 {
     return CPos(x - rhs.x, y - rhs.y);
+}
+
+CPos CPos::interpolate(const CPos &from, const CPos &to, double alpha)
+{
+    if (std::abs(to.x - from.x) > 1 || std::abs(to.y - from.y) > 1)
+        return to;
+
+    return CPos(from.x + (to.x - from.x) * alpha, from.y + (to.y - from.y) * alpha);
 }
\ No newline at end of file
@@ -35,4 +35,12 @@ struct CPos
     ///
     /// @param [in] rhs right operand
     CPos operator-(const CPos &rhs);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Linearly interpolates between two positions. If they are more than a tile apart (a teleport or a tunnel), the target position is returned.
+    ///
+    /// @param [in] from position at alpha = 0
+    /// @param [in] to position at alpha = 1
+    /// @param [in] alpha interpolation factor, from 0 to 1
+    static CPos interpolate(const CPos &from, const CPos &to, double alpha);
 };
\ No newline at end of file
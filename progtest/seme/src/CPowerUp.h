@@ -3,28 +3,21 @@
 #include "CCollectible.h"
 
 /** \class CPowerUp
-A class that represents a power pelet that allows the player to eat the gosts for a limited time. It implements the abstract draw and doEffect methods.
+A class that represents a power pelet that allows the player to eat the gosts for a limited time.
 */
-class CPowerUp : public CCollectible
+class CPowerUp
 {
 public:
     ////////////////////////////////////////////////////////////////////////////////
-    /// Constructor that creates the power up at a specified position
+    /// Draws the power up on the screen at a position.
     ///
-    /// @param [in] pos position
-    CPowerUp(CPos pos) : CCollectible(pos){};
+    /// @param [in] canvas the canvas to draw on
+    /// @param [in] pos position of the power up
+    static void draw(CCanvas &canvas, CPos pos);
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// Draws the power up on the screen according to it's position.
-    ///
-    /// @param [in] renderer a pointer to the SDL_Renderer
-    /// @param [in] gamestate a gamestate instance
-    virtual void draw(SDL_Renderer *renderer, CGameState &gamestate) override;
-
-private:
-    ////////////////////////////////////////////////////////////////////////////////
-    /// Implementation of the abstract doEffect, gives player the power up effect
+    /// Does the effect of the power up, gives player the power up effect
     ///
     /// @param [out] gamestate a gamestate instance
-    virtual void doEffect(CGameState &gamestate) override;
+    static void doEffect(CGameState &gamestate);
 };
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "CProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+CProfiler::CScope::CScope(CProfiler *profiler, CPhase phase) : profiler(profiler), phase(phase)
+{
+    if (profiler != nullptr)
+        start = std::chrono::steady_clock::now();
+}
+
+CProfiler::CScope::~CScope()
+{
+    if (profiler != nullptr)
+        profiler->addTime(phase, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+}
+
+CProfiler::CProfiler() : frames(CAPACITY)
+{
+    sorted.reserve(CAPACITY);
+}
+
+void CProfiler::beginFrame()
+{
+    current = CFrame();
+    current.number = frames[(next + CAPACITY - 1) % CAPACITY].number + (count > 0);
+    frameStart = std::chrono::steady_clock::now();
+    cpuStart = std::clock();
+}
+
+void CProfiler::endFrame()
+{
+    current.total = std::chrono::duration<double>(std::chrono::steady_clock::now() - frameStart).count();
+    current.cpuTime = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+    frames[next] = current;
+    next = (next + 1) % CAPACITY;
+    count = std::min(count + 1, CAPACITY);
+}
+
+void CProfiler::addTime(CPhase phase, double seconds)
+{
+    current.phases[phase] += seconds;
+}
+
+void CProfiler::addInputLatency(double seconds)
+{
+    current.inputLatency = std::max(current.inputLatency, seconds);
+}
+
+size_t CProfiler::getFrameCount() const
+{
+    return count;
+}
+
+const CProfiler::CFrame &CProfiler::getFrame(size_t frame) const
+{
+    return frames[(next + CAPACITY - count + frame) % CAPACITY];
+}
+
+double CProfiler::getFrameTime(size_t frame) const
+{
+    return getFrame(frame).total;
+}
+
+double CProfiler::getPhaseTime(size_t frame, CPhase phase) const
+{
+    return getFrame(frame).phases[phase];
+}
+
+double CProfiler::getInputLatency(size_t frame) const
+{
+    return getFrame(frame).inputLatency;
+}
+
+double CProfiler::getCpuTime(size_t frame) const
+{
+    return getFrame(frame).cpuTime;
+}
+
+double CProfiler::getPercentile(double percentile)
+{
+    if (count == 0)
+        return 0;
+
+    sorted.clear();
+    for (size_t frame = 0; frame < count; frame++)
+        sorted.push_back(getFrame(frame).total);
+
+    std::vector<double>::iterator nth = sorted.begin() + static_cast<size_t>(std::round(percentile * (count - 1)));
+    std::nth_element(sorted.begin(), nth, sorted.end());
+    return *nth;
+}
+
+const char *CProfiler::getPhaseName(CPhase phase)
+{
+    switch (phase)
+    {
+    case input:
+        return "input";
+    case playerMovement:
+        return "player_movement";
+    case gameModes:
+        return "game_modes";
+    case collectibles:
+        return "collectibles";
+    case ghosts:
+        return "ghosts";
+    case drawMap:
+        return "draw_map";
+    case drawGameObjects:
+        return "draw_game_objects";
+    case drawGUI:
+        return "draw_gui";
+    case present:
+        return "present";
+    case pacing:
+        return "pacing";
+    default:
+        return "unknown";
+    }
+}
+
+bool CProfiler::writeCSV(const std::string &path) const
+{
+    std::ofstream csv(path);
+    if (!csv.is_open())
+        return false;
+
+    csv << "frame,total_ms";
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+        csv << ',' << getPhaseName(static_cast<CPhase>(phase)) << "_ms";
+    csv << ",input_latency_ms,cpu_ms\n";
+
+    for (size_t frame = 0; frame < count; frame++)
+    {
+        const CFrame &data = getFrame(frame);
+        csv << data.number << ',' << data.total * 1000;
+        for (int phase = 0; phase < PHASE_COUNT; phase++)
+            csv << ',' << data.phases[phase] * 1000;
+        csv << ',' << data.inputLatency * 1000 << ',' << data.cpuTime * 1000 << '\n';
+    }
+
+    return static_cast<bool>(csv);
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/** \class CProfiler
+Measures how long every frame and every phase of a frame takes, and how much CPU time the process spent in it. The last CAPACITY frames are kept in a ring buffer.
+
+A phase can run several times in a frame (the simulation phases run once per step), its times are summed.
+It does not depend on SDL, the game's overlay and the CSV dump only read the buffer.
+*/
+class CProfiler
+{
+public:
+    static constexpr size_t CAPACITY = 4096; ///< number of frames kept, about a minute at 60 frames per second
+
+    /** \class CPhase
+    The measured phases of a frame.
+    */
+    enum CPhase
+    {
+        input,           ///< processing the SDL events
+        playerMovement,  ///< moving the player, in every step of the frame
+        gameModes,       ///< updateGameModes, in every step of the frame
+        collectibles,    ///< updating the collectibles, in every step of the frame
+        ghosts,          ///< moving the ghosts and their collisions with the player, in every step of the frame
+        drawMap,         ///< drawing the board
+        drawGameObjects, ///< drawing the ghosts and the player
+        drawGUI,         ///< drawing the text and the overlays
+        present,         ///< SDL_RenderPresent, it waits for the display with vsync
+        pacing,          ///< waiting for the next frame in the capped mode
+        PHASE_COUNT      ///< number of the phases
+    };
+
+    /** \class CScope
+    Measures a phase from its construction to its destruction. Does nothing if there is no profiler.
+    */
+    class CScope
+    {
+    public:
+        ////////////////////////////////////////////////////////////////////////////////
+        /// Starts measuring a phase.
+        ///
+        /// @param [in] profiler the profiler, can be nullptr
+        /// @param [in] phase the phase
+        CScope(CProfiler *profiler, CPhase phase);
+        CScope(const CScope &) = delete;
+        CScope &operator=(const CScope &) = delete;
+
+        ////////////////////////////////////////////////////////////////////////////////
+        /// Adds the time since the construction to the phase.
+        ~CScope();
+
+    private:
+        CProfiler *profiler;                           ///< the profiler, can be nullptr
+        CPhase phase;                                  ///< the measured phase
+        std::chrono::steady_clock::time_point start{}; ///< when the phase started
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Allocates the ring buffer.
+    CProfiler();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Starts measuring a new frame.
+    void beginFrame();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Stores the frame started by beginFrame in the ring buffer, overwriting the oldest one if it is full.
+    void endFrame();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Adds time to a phase of the current frame.
+    ///
+    /// @param [in] phase the phase
+    /// @param [in] seconds the time
+    void addTime(CPhase phase, double seconds);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Records the time from a key press to the present of the first frame showing its effect. The longest one of a frame is kept.
+    ///
+    /// @param [in] seconds the latency
+    void addInputLatency(double seconds);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the number of frames in the ring buffer.
+    size_t getFrameCount() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the time of a frame in the ring buffer, in seconds.
+    ///
+    /// @param [in] frame index of the frame, 0 is the oldest one
+    double getFrameTime(size_t frame) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the time of a phase of a frame in the ring buffer, in seconds.
+    ///
+    /// @param [in] frame index of the frame, 0 is the oldest one
+    /// @param [in] phase the phase
+    double getPhaseTime(size_t frame, CPhase phase) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the longest input latency of a frame in the ring buffer, in seconds. 0 if no input took effect in the frame.
+    ///
+    /// @param [in] frame index of the frame, 0 is the oldest one
+    double getInputLatency(size_t frame) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the CPU time the process spent in a frame in the ring buffer, in seconds. All threads are counted.
+    ///
+    /// @param [in] frame index of the frame, 0 is the oldest one
+    double getCpuTime(size_t frame) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns a percentile of the frame times in the ring buffer, in seconds. 0 if it is empty.
+    ///
+    /// @param [in] percentile the percentile, from 0 to 1. 1 is the longest frame.
+    double getPercentile(double percentile);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the name of a phase, as used in the CSV header.
+    ///
+    /// @param [in] phase the phase
+    static const char *getPhaseName(CPhase phase);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Writes the frames in the ring buffer to a CSV file, one line per frame from the oldest one. Times are in milliseconds.
+    ///
+    /// @param [in] path path to the file
+    /// @return false if the file cannot be written
+    bool writeCSV(const std::string &path) const;
+
+private:
+    /** \class CFrame
+    The measured times of a single frame.
+    */
+    struct CFrame
+    {
+        unsigned long long number = 0;   ///< number of the frame since the start
+        double total = 0;                ///< seconds from beginFrame to endFrame
+        double phases[PHASE_COUNT] = {}; ///< seconds spent in every phase
+        double inputLatency = 0;         ///< the longest input latency of the frame, 0 if no input took effect
+        double cpuTime = 0;              ///< CPU seconds of the process from beginFrame to endFrame
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns a frame in the ring buffer.
+    ///
+    /// @param [in] frame index of the frame, 0 is the oldest one
+    const CFrame &getFrame(size_t frame) const;
+
+    std::vector<CFrame> frames;                         ///< the ring buffer
+    size_t next = 0;                                    ///< index the next frame is stored at
+    size_t count = 0;                                   ///< number of frames stored
+    CFrame current;                                     ///< the frame being measured
+    std::chrono::steady_clock::time_point frameStart{}; ///< when the current frame started
+    std::clock_t cpuStart = 0;                          ///< CPU time of the process when the current frame started
+    std::vector<double> sorted;                         ///< scratch buffer for the percentiles, allocated once
+};
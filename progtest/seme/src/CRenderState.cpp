@@ -0,0 +1,21 @@
+#include "CRenderState.h"
+
+CRenderState::CRenderState()
+{
+    topScores.reserve(CScoreStore::TOP_COUNT);
+}
+
+void CRenderState::capture(const CGame &game)
+{
+    const CGameState &gamestate = game.gamestate;
+
+    ghosts = game.ghosts; // the vectors keep their capacity, so this is a plain copy
+    collectibles.follow(game.collectibles);
+    playerPos = gamestate.playerPos;
+    previousPlayerPos = gamestate.previousPlayerPos;
+    gamemode = gamestate.gamemode;
+    screen = gamestate.screen;
+    score = gamestate.score;
+    level = gamestate.level;
+    topScores = gamestate.highscores.getTop();
+}
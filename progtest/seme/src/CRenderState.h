@@ -0,0 +1,45 @@
+#pragma once
+
+#include "CGame.h"
+#include "CInputQueue.h"
+#include "CProfiler.h"
+
+#include <chrono>
+#include <utility>
+#include <vector>
+
+/** \class CRenderState
+Everything the renderer needs to draw a step that changes while the game is played: the actors, the collectibles, the mode, the screen and the scores.
+
+The simulation thread captures it after its steps and publishes it to the render thread, which then draws it while the game goes on.
+The configuration and the map do not change while the game runs, the render thread reads them from its own copy of the gamestate.
+Capturing a state reuses the memory of the previous one, so once the vectors have grown to the size of the level, it allocates nothing.
+*/
+struct CRenderState
+{
+    CGhostStore ghosts;                                            ///< the ghosts
+    CCollectibleGrid collectibles;                                 ///< the collectibles, kept up to date with the pickups of the game
+    CPos playerPos;                                                ///< current position of the player
+    CPos previousPlayerPos;                                        ///< position of the player before the last step, used for render interpolation
+    CGameState::CGameMode gamemode = CGameState::CGameMode::chase; ///< the gamemode
+    CGameState::CScreen screen = CGameState::CScreen::start;       ///< currently active screen
+    int score = 0;                                                 ///< current score
+    int level = 1;                                                 ///< current level
+    std::vector<std::pair<int, int>> topScores;                    ///< the best scores with their levels, sorted highest to lowest
+
+    std::chrono::steady_clock::time_point time{};   ///< when the state was captured
+    double alpha = 1;                               ///< how far the game was between the previous and the current step when the state was captured, from 0 to 1
+    unsigned long long moveCount = 0;               ///< number of the moves applied so far
+    CInputQueue::CTime lastMoveTime{};              ///< when the key of the last applied move was pressed
+    double phaseTimes[CProfiler::PHASE_COUNT] = {}; ///< seconds spent in every phase by the simulation thread so far
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Reserves the best scores.
+    CRenderState();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Copies the state of a game. The collectibles only take over the pickups they are missing, unless a level was loaded or the game was restored.
+    ///
+    /// @param [in] game the game
+    void capture(const CGame &game);
+};
@@ -0,0 +1,212 @@
+#include "CReplay.h"
+#include "CGameState.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+static_assert(std::is_trivially_copyable_v<CReplayHeader> && sizeof(CReplayHeader) == 80, "the header is written as it is, its layout must not change");
+
+void CReplay::begin(const CGameState &gamestate)
+{
+    header = {};
+    std::copy(MAGIC, MAGIC + 4, header.magic);
+    header.version = VERSION;
+    header.playerSpeed = gamestate.PLAYER_SPEED;
+    header.initialPowerUpTime = gamestate.INITIAL_POWERUP_TIME;
+    header.powerUpTimeDecrement = gamestate.POWER_UP_TIME_DECREMENT;
+    header.timeBetweenGuardMode = gamestate.TIME_BETWEEN_GUARD_MODE;
+    header.initialGuardTime = gamestate.INITIAL_GUARD_TIME;
+    header.guardTimeDecrement = gamestate.GUARD_TIME_DECREMENT;
+    header.powerUpGhostSlowdown = gamestate.POWER_UP_GHOST_SLOWDOWN;
+    header.spawnCount = gamestate.SPAWN_COUNT;
+    header.mapHash = CDistanceTable::hashMap(gamestate.gameMap);
+
+    runs.clear();
+    runs.reserve(RESERVED_BYTES);
+    runMove = CDirection::none;
+    runLength = 0;
+    recording = true;
+}
+
+void CReplay::record(const CGameState &gamestate, uint64_t steps)
+{
+    if (!recording)
+        return;
+
+    if (gamestate.nextMove != runMove && runLength > 0)
+        flush();
+
+    runMove = gamestate.nextMove;
+    runLength += steps;
+    header.tickCount += steps;
+}
+
+void CReplay::flush()
+{
+    runs.push_back(static_cast<uint8_t>(runMove));
+
+    uint64_t length = runLength;
+    while (length >= 0x80)
+    {
+        runs.push_back(static_cast<uint8_t>(length & 0x7f) | 0x80);
+        length >>= 7;
+    }
+    runs.push_back(static_cast<uint8_t>(length));
+
+    header.runCount++;
+    runLength = 0;
+}
+
+void CReplay::finish(const CGameState &gamestate)
+{
+    if (!recording)
+        return;
+
+    if (runLength > 0)
+        flush();
+
+    header.score = gamestate.score;
+    header.level = gamestate.level;
+    recording = false;
+}
+
+void CReplay::discard()
+{
+    recording = false;
+    header = {};
+    runs.clear();
+}
+
+bool CReplay::isRecording() const
+{
+    return recording;
+}
+
+bool CReplay::write(const std::string &path) const
+{
+    // written to a temporary file first, so that a corpus never holds half of a replay
+    std::string temporaryPath = path + ".tmp";
+    std::ofstream file(temporaryPath, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(runs.data()), runs.size());
+    file.close();
+
+    if (!file || std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void CReplay::load(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        throw std::invalid_argument("unable to open replay file");
+
+    CReplayHeader loaded;
+    if (!file.read(reinterpret_cast<char *>(&loaded), sizeof(loaded)))
+        throw std::invalid_argument("replay file too short");
+    if (!std::equal(loaded.magic, loaded.magic + 4, MAGIC))
+        throw std::invalid_argument("not a replay file");
+    if (loaded.version != VERSION)
+        throw std::invalid_argument("replay file of another version, it would not play the same");
+    if (loaded.spawnCount < 1 || loaded.spawnCount > CGameState::MAX_SPAWN_COUNT)
+        throw std::invalid_argument("replay spawn count out of range");
+
+    std::vector<uint8_t> loadedRuns((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // every run has to be complete, and together they have to cover the recorded steps
+    uint64_t ticks = 0;
+    uint64_t runCount = 0;
+    for (size_t i = 0; i < loadedRuns.size(); runCount++)
+    {
+        if (loadedRuns[i++] > static_cast<uint8_t>(CDirection::right))
+            throw std::invalid_argument("replay run with an unknown move");
+
+        uint64_t length = 0;
+        int shift = 0;
+        do
+        {
+            if (i == loadedRuns.size() || shift > 56)
+                throw std::invalid_argument("replay run cut off");
+            length |= static_cast<uint64_t>(loadedRuns[i] & 0x7f) << shift;
+            shift += 7;
+        } while (loadedRuns[i++] & 0x80);
+
+        if (length == 0)
+            throw std::invalid_argument("replay run of no steps");
+        ticks += length;
+    }
+
+    if (runCount != loaded.runCount || ticks != loaded.tickCount)
+        throw std::invalid_argument("replay runs do not match the header");
+
+    header = loaded;
+    runs = std::move(loadedRuns);
+    recording = false;
+    restart();
+}
+
+void CReplay::configure(CGameState &gamestate) const
+{
+    if (CDistanceTable::hashMap(gamestate.gameMap) != header.mapHash)
+        throw std::invalid_argument("the replay was recorded on another map");
+
+    gamestate.PLAYER_SPEED = header.playerSpeed;
+    gamestate.INITIAL_POWERUP_TIME = header.initialPowerUpTime;
+    gamestate.POWER_UP_TIME_DECREMENT = header.powerUpTimeDecrement;
+    gamestate.TIME_BETWEEN_GUARD_MODE = header.timeBetweenGuardMode;
+    gamestate.INITIAL_GUARD_TIME = header.initialGuardTime;
+    gamestate.GUARD_TIME_DECREMENT = header.guardTimeDecrement;
+    gamestate.POWER_UP_GHOST_SLOWDOWN = header.powerUpGhostSlowdown;
+    gamestate.SPAWN_COUNT = header.spawnCount;
+
+    gamestate.powerUpTime = gamestate.INITIAL_POWERUP_TIME;
+    gamestate.guardTime = gamestate.INITIAL_GUARD_TIME;
+    gamestate.nextGuard = gamestate.TIME_BETWEEN_GUARD_MODE;
+}
+
+void CReplay::restart()
+{
+    offset = 0;
+    runLength = 0;
+    runMove = CDirection::none;
+}
+
+bool CReplay::apply(CGameState &gamestate)
+{
+    if (runLength == 0)
+    {
+        if (offset == runs.size())
+            return false;
+
+        // the runs were checked when the file was loaded
+        runMove = static_cast<CDirection>(runs[offset++]);
+        int shift = 0;
+        do
+        {
+            runLength |= static_cast<uint64_t>(runs[offset] & 0x7f) << shift;
+            shift += 7;
+        } while (runs[offset++] & 0x80);
+    }
+
+    gamestate.nextMove = runMove;
+    runLength--;
+    return true;
+}
+
+const CReplayHeader &CReplay::getHeader() const
+{
+    return header;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "CDirection.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct CGameState;
+
+/** \class CReplayHeader
+The header at the start of a replay file: what the game needs to start the same way, and how the recorded game ended.
+*/
+struct CReplayHeader
+{
+    char magic[4];                ///< file signature, CReplay::MAGIC
+    uint32_t version;             ///< CReplay::VERSION of the game that recorded the file
+    int32_t playerSpeed;          ///< PLAYER_SPEED
+    int32_t initialPowerUpTime;   ///< INITIAL_POWERUP_TIME
+    int32_t powerUpTimeDecrement; ///< POWER_UP_TIME_DECREMENT
+    int32_t timeBetweenGuardMode; ///< TIME_BETWEEN_GUARD_MODE
+    int32_t initialGuardTime;     ///< INITIAL_GUARD_TIME
+    int32_t guardTimeDecrement;   ///< GUARD_TIME_DECREMENT
+    double powerUpGhostSlowdown;  ///< POWER_UP_GHOST_SLOWDOWN
+    uint64_t mapHash;             ///< hash of the map the game was played on, see CDistanceTable::hashMap
+    uint64_t tickCount;           ///< number of steps recorded
+    uint64_t runCount;            ///< number of runs following the header
+    int32_t score;                ///< score at the end of the recorded game
+    int32_t level;                ///< level at the end of the recorded game
+    int32_t spawnCount;           ///< SPAWN_COUNT
+    int32_t reserved;             ///< always 0, keeps the size a multiple of 8
+};
+
+/** \class CReplay
+The player's moves of a whole game, one per fixed step, recorded so that the game can be simulated again exactly as it was played.
+
+The move the player wants to take next (CGameState::nextMove) is recorded before every step. It only changes on a key press, so it is stored run-length encoded:
+every run is a byte with the move followed by the number of steps it was held, written in 7-bit groups (the highest bit of a byte is set if another one follows).
+A minute of play is 7680 steps, but usually only a few hundred bytes.
+
+Playing a replay sets nextMove before every step from the runs again. The config constants are taken from the header, the map has to be the same one.
+*/
+class CReplay
+{
+public:
+    static constexpr char MAGIC[4] = {'P', 'M', 'R', 'P'}; ///< file signature of replay files
+    static constexpr uint32_t VERSION = 2;                 ///< bumped whenever the file layout or the simulation changes, older replays would not play the same
+    static constexpr size_t RESERVED_BYTES = 1 << 16;      ///< memory for the runs allocated by begin, a run takes 2 or 3 bytes, so a game rarely needs more
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Starts recording a new game. Called right after the game was set up, before its first step. The memory for the runs is allocated here,
+    /// so recording does not allocate while the game is played.
+    ///
+    /// @param [in] gamestate the gamestate of the game, the config constants and the map are taken from it
+    void begin(const CGameState &gamestate);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Records the move of the next steps. Called before every step, does nothing if nothing is being recorded.
+    ///
+    /// @param [in] gamestate the gamestate of the game
+    /// @param [in] steps number of steps taken with the move, more than one when steps are skipped over (see CEventSimulation)
+    void record(const CGameState &gamestate, uint64_t steps = 1);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Ends the recording, e.g. when the game is over. The score and the level are kept to check a playback against.
+    ///
+    /// @param [in] gamestate the gamestate of the game
+    void finish(const CGameState &gamestate);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Stops recording without finishing, the moves cannot be played back anymore. Called when the game jumps to another state (rewind, loading a saved game).
+    void discard();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Checks if a game is being recorded.
+    bool isRecording() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Saves a finished recording to a file.
+    ///
+    /// @param [in] path path to the replay file
+    /// @return true if the file was written
+    bool write(const std::string &path) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Loads a replay file and prepares it to be played from the first step.
+    ///
+    /// @param [in] path path to the replay file
+    /// @throws std::invalid_argument if the file cannot be read, was written by another version or its runs do not add up to its steps
+    void load(const std::string &path);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Sets the config constants of a gamestate to the recorded ones. Called before the game is set up.
+    ///
+    /// @param [in, out] gamestate a gamestate with the map already loaded
+    /// @throws std::invalid_argument if the map is not the one the replay was recorded on
+    void configure(CGameState &gamestate) const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Goes back to the first step, so that the replay can be played again.
+    void restart();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Sets the move of the next step. Called before every step instead of taking the player's input.
+    ///
+    /// @param [in, out] gamestate the gamestate of the game
+    /// @return false if all steps were played
+    bool apply(CGameState &gamestate);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the header of the replay.
+    const CReplayHeader &getHeader() const;
+
+private:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Appends the run that is being recorded to the runs.
+    void flush();
+
+    CReplayHeader header = {};             ///< the header, filled while recording or loaded from the file
+    std::vector<uint8_t> runs;             ///< the encoded runs
+    bool recording = false;                ///< true between begin and finish (or discard)
+    CDirection runMove = CDirection::none; ///< the move of the current run
+    uint64_t runLength = 0;                ///< while recording, the steps of the current run so far. While playing, the steps left of it.
+    size_t offset = 0;                     ///< while playing, where the next run starts in runs
+};
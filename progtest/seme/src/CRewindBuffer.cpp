@@ -0,0 +1,46 @@
+#include "CRewindBuffer.h"
+
+CRewindBuffer::CRewindBuffer()
+    : snapshots(CAPACITY)
+{
+}
+
+void CRewindBuffer::record(const CGame &game)
+{
+    if (++steps < INTERVAL)
+        return;
+    steps = 0;
+
+    game.saveState(snapshots[newest]);
+    newest = (newest + 1) % CAPACITY;
+    if (count < CAPACITY)
+        count++;
+}
+
+void CRewindBuffer::reserve(const CGame &game)
+{
+    CGameSnapshot sample;
+    game.saveState(sample);
+
+    for (CGameSnapshot &snapshot : snapshots)
+        snapshot.reserve(sample.size());
+}
+
+bool CRewindBuffer::rewind(CGame &game)
+{
+    if (count == 0)
+        return false;
+
+    newest = (newest + CAPACITY - 1) % CAPACITY;
+    count--;
+    steps = 0;
+
+    return game.restoreState(snapshots[newest]);
+}
+
+void CRewindBuffer::clear()
+{
+    newest = 0;
+    count = 0;
+    steps = 0;
+}
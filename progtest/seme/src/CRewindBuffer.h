@@ -0,0 +1,52 @@
+#pragma once
+
+#include "CGame.h"
+#include "CGameSnapshot.h"
+
+#include <vector>
+
+/** \class CRewindBuffer
+The last few seconds of a game, as a ring of snapshots taken every few steps. Rewinding restores them from the newest to the oldest.
+
+The snapshots are reused when the ring wraps around, so once every slot was filled, recording allocates nothing.
+*/
+class CRewindBuffer
+{
+public:
+    static constexpr int INTERVAL = 8;     ///< Steps. A snapshot is taken every INTERVAL steps, 16 times a second.
+    static constexpr size_t CAPACITY = 80; ///< number of snapshots kept, INTERVAL * CAPACITY steps are 5 seconds of the game
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Allocates the ring.
+    CRewindBuffer();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Called after every step of the game, takes a snapshot every INTERVAL calls. The oldest snapshot is overwritten when the ring is full.
+    ///
+    /// @param [in] game the game
+    void record(const CGame &game);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Allocates every slot for a snapshot of a game, so that filling the ring does not allocate while the game is played.
+    /// The snapshots of a level do not change in size, so it is enough to call this once after the game is set up.
+    ///
+    /// @param [in] game the game
+    void reserve(const CGame &game);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Restores the newest snapshot and removes it, so that the next call goes further back.
+    ///
+    /// @param [in, out] game the game
+    /// @return false if there is no snapshot left
+    bool rewind(CGame &game);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Removes all snapshots, e.g. when a game is loaded or restarted. The memory is kept.
+    void clear();
+
+private:
+    std::vector<CGameSnapshot> snapshots; ///< the ring of snapshots
+    size_t newest = 0;                    ///< index of the slot written next
+    size_t count = 0;                     ///< number of snapshots kept
+    int steps = 0;                        ///< steps since the last snapshot
+};
@@ -0,0 +1,41 @@
+#include "CSDLCanvas.h"
+
+CSDLCanvas::CSDLCanvas(CSpriteBatch &batch, const CCamera &camera, const CGameState &gamestate) : batch(batch), camera(camera)
+{
+    resize(gamestate);
+}
+
+void CSDLCanvas::resize(const CGameState &gamestate)
+{
+    tileWidth = gamestate.WINDOW_WIDTH / static_cast<double>(gamestate.VIEW_WIDTH);
+    tileHeight = gamestate.WINDOW_HEIGHT / static_cast<double>(gamestate.VIEW_HEIGHT);
+    windowWidth = gamestate.WINDOW_WIDTH;
+    windowHeight = gamestate.WINDOW_HEIGHT;
+}
+
+void CSDLCanvas::fillTile(CPos pos, double scale, int R, int G, int B)
+{
+    const double offset = (1 - scale) / 2;
+    const CPos origin = camera.getOrigin();
+
+    SDL_Rect rect =
+        {static_cast<int>(tileWidth * (pos.x - origin.x) + static_cast<int>(tileWidth * offset)),
+         static_cast<int>(tileHeight * (pos.y - origin.y) + static_cast<int>(tileHeight * offset)),
+         static_cast<int>(tileWidth * scale),
+         static_cast<int>(tileHeight * scale)};
+
+    if (rect.x + rect.w <= 0 || rect.y + rect.h <= 0 || rect.x >= windowWidth || rect.y >= windowHeight)
+        return;
+
+    batch.add(rect, R, G, B);
+}
+
+SDL_Rect CSDLCanvas::getTileRect(int x, int y) const
+{
+    const CPos origin = camera.getOrigin();
+
+    return {static_cast<int>(tileWidth * (x - origin.x)),
+            static_cast<int>(tileHeight * (y - origin.y)),
+            static_cast<int>(tileWidth),
+            static_cast<int>(tileHeight)};
+}
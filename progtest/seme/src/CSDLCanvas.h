@@ -0,0 +1,54 @@
+#pragma once
+
+#include "CCanvas.h"
+#include "CCamera.h"
+#include "CGameState.h"
+#include "CSpriteBatch.h"
+
+/** \class CSDLCanvas
+A canvas that draws into a sprite batch. Converts board coordinates to pixels using tile metrics computed from the window dimensions and the position of the camera.
+
+Squares that end up completely outside of the window are dropped before they reach the batch.
+*/
+class CSDLCanvas : public CCanvas
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Constructor that binds the canvas to a sprite batch
+    ///
+    /// @param [in] batch the sprite batch the quads are added to
+    /// @param [in] camera the camera that decides which part of the board is shown
+    /// @param [in] gamestate a gamestate instance. Used to read the window dimensions.
+    CSDLCanvas(CSpriteBatch &batch, const CCamera &camera, const CGameState &gamestate);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Recomputes the tile metrics. Has to be called whenever the window dimensions change.
+    ///
+    /// @param [in] gamestate a gamestate instance. Used to read the window dimensions.
+    void resize(const CGameState &gamestate);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Adds a square centered in the tile at the given position to the batch, unless it is outside of the window
+    ///
+    /// @param [in] pos position on the game board, in tiles
+    /// @param [in] scale size of the square relative to the size of a tile
+    /// @param [in] R red
+    /// @param [in] G green
+    /// @param [in] B blue
+    virtual void fillTile(CPos pos, double scale, int R, int G, int B) override;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the rectangle of a whole tile in pixels, relative to the camera.
+    ///
+    /// @param [in] x x coordinate of the tile
+    /// @param [in] y y coordinate of the tile
+    SDL_Rect getTileRect(int x, int y) const;
+
+private:
+    CSpriteBatch &batch;   ///< the batch that is drawn into
+    const CCamera &camera; ///< the camera the board coordinates are relative to
+    double tileWidth = 0;  ///< width of a tile in pixels
+    double tileHeight = 0; ///< height of a tile in pixels
+    int windowWidth = 0;   ///< width of the board part of the window in pixels
+    int windowHeight = 0;  ///< height of the board part of the window in pixels
+};
@@ -0,0 +1,271 @@
+#include "CScoreStore.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(std::is_trivially_copyable_v<CScoreRecord> && sizeof(CScoreRecord) == 12, "records are written as they are, their layout must not change");
+
+constexpr char LOG_MAGIC[4] = {'P', 'M', 'S', 'L'};   // file signature of the score log
+constexpr char INDEX_MAGIC[4] = {'P', 'M', 'S', 'I'}; // file signature of the index of the best scores
+constexpr uint32_t SCORE_VERSION = 1;                 // bumped whenever the layout of either file changes
+constexpr uint64_t LOG_HEADER_SIZE = 8;               // the signature and the version at the start of the log
+constexpr size_t READ_RECORDS = 4096;                 // records read from the log at once
+
+bool CScoreStore::open(const std::string &directory)
+{
+    logPath = directory + "/scores.log";
+    indexPath = directory + "/scores.idx";
+    top.clear();
+    logSize = LOG_HEADER_SIZE;
+    count = 0;
+
+    struct stat status;
+    if (stat(logPath.c_str(), &status) != 0)
+    {
+        int log = ::open(logPath.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+        if (log < 0)
+        {
+            logPath.clear();
+            return false;
+        }
+
+        char header[LOG_HEADER_SIZE];
+        std::copy(LOG_MAGIC, LOG_MAGIC + 4, header);
+        std::copy(reinterpret_cast<const char *>(&SCORE_VERSION), reinterpret_cast<const char *>(&SCORE_VERSION) + 4, header + 4);
+        bool written = write(log, header, sizeof(header)) == sizeof(header) && fdatasync(log) == 0;
+        close(log);
+
+        if (!written)
+        {
+            std::remove(logPath.c_str());
+            logPath.clear();
+            return false;
+        }
+
+        // the scores of older versions are moved over once, the text file is left as it was
+        std::string score;
+        std::string level;
+        std::ifstream highscores(directory + "/highscores.txt");
+        while (getline(highscores, score, ';') && getline(highscores, level))
+            add(atoi(score.c_str()), atoi(level.c_str()));
+
+        writeIndex();
+        return true;
+    }
+
+    bool indexed = readIndex();
+    uint64_t indexedSize = logSize;
+
+    if (!readLog())
+    {
+        logPath.clear();
+        return false;
+    }
+
+    if (!indexed || logSize != indexedSize)
+        writeIndex();
+
+    return true;
+}
+
+bool CScoreStore::readIndex()
+{
+    std::ifstream index(indexPath, std::ios::binary);
+    if (!index.is_open())
+        return false;
+
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t indexedSize = 0;
+    uint64_t indexedCount = 0;
+    uint32_t topCount = 0;
+
+    index.read(magic, sizeof(magic));
+    index.read(reinterpret_cast<char *>(&version), sizeof(version));
+    index.read(reinterpret_cast<char *>(&indexedSize), sizeof(indexedSize));
+    index.read(reinterpret_cast<char *>(&indexedCount), sizeof(indexedCount));
+    index.read(reinterpret_cast<char *>(&topCount), sizeof(topCount));
+
+    if (!index ||
+        !std::equal(magic, magic + 4, INDEX_MAGIC) ||
+        version != SCORE_VERSION ||
+        indexedSize < LOG_HEADER_SIZE ||
+        topCount > TOP_COUNT)
+        return false;
+
+    std::vector<std::pair<int, int>> indexed;
+    for (uint32_t i = 0; i < topCount; i++)
+    {
+        int32_t entry[2];
+        if (!index.read(reinterpret_cast<char *>(entry), sizeof(entry)))
+            return false;
+        indexed.push_back({entry[0], entry[1]});
+    }
+
+    top = indexed;
+    logSize = indexedSize;
+    count = indexedCount;
+    return true;
+}
+
+bool CScoreStore::readLog()
+{
+    int log = ::open(logPath.c_str(), O_RDWR);
+    if (log < 0)
+        return false;
+
+    struct stat status;
+    char header[LOG_HEADER_SIZE];
+    if (fstat(log, &status) != 0 ||
+        pread(log, header, sizeof(header), 0) != sizeof(header) ||
+        !std::equal(header, header + 4, LOG_MAGIC) ||
+        !std::equal(header + 4, header + 8, reinterpret_cast<const char *>(&SCORE_VERSION)))
+    {
+        close(log);
+        return false;
+    }
+
+    uint64_t size = status.st_size;
+
+    // an index that covers more than the log holds belongs to another log, the whole log is read instead
+    if (logSize > size)
+    {
+        top.clear();
+        logSize = LOG_HEADER_SIZE;
+        count = 0;
+    }
+
+    // a record cut off by a crash is removed, so that the next one is appended at a record boundary
+    uint64_t end = size - (size - LOG_HEADER_SIZE) % sizeof(CScoreRecord);
+    if (end != size && ftruncate(log, end) != 0)
+    {
+        close(log);
+        return false;
+    }
+
+    std::vector<CScoreRecord> records(READ_RECORDS);
+    while (logSize < end)
+    {
+        size_t bytes = std::min<uint64_t>(end - logSize, READ_RECORDS * sizeof(CScoreRecord));
+        if (pread(log, records.data(), bytes, logSize) != static_cast<ssize_t>(bytes))
+        {
+            close(log);
+            return false;
+        }
+
+        for (size_t i = 0; i < bytes / sizeof(CScoreRecord); i++)
+            if (records[i].check == getCheck(records[i].score, records[i].level)) // a record damaged on the disk is skipped
+            {
+                insert(records[i].score, records[i].level);
+                count++;
+            }
+
+        logSize += bytes;
+    }
+
+    close(log);
+    return true;
+}
+
+void CScoreStore::writeIndex() const
+{
+    std::string temporaryPath = indexPath + ".tmp";
+    std::ofstream index(temporaryPath, std::ios::binary);
+    if (!index.is_open())
+        return;
+
+    uint32_t topCount = top.size();
+
+    index.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    index.write(reinterpret_cast<const char *>(&SCORE_VERSION), sizeof(SCORE_VERSION));
+    index.write(reinterpret_cast<const char *>(&logSize), sizeof(logSize));
+    index.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    index.write(reinterpret_cast<const char *>(&topCount), sizeof(topCount));
+    for (const std::pair<int, int> &entry : top)
+    {
+        int32_t values[2] = {entry.first, entry.second};
+        index.write(reinterpret_cast<const char *>(values), sizeof(values));
+    }
+    index.close();
+
+    // a missing index is rebuilt from the log, so a failed write only costs time on the next start
+    if (index)
+        std::rename(temporaryPath.c_str(), indexPath.c_str());
+    else
+        std::remove(temporaryPath.c_str());
+}
+
+bool CScoreStore::add(int score, int level)
+{
+    insert(score, level);
+    count++;
+
+    if (logPath.empty())
+        return true;
+
+    int log = ::open(logPath.c_str(), O_WRONLY | O_APPEND);
+    if (log < 0)
+        return false;
+
+    CScoreRecord record = {score, level, getCheck(score, level)};
+    bool written = write(log, &record, sizeof(record)) == sizeof(record) && fdatasync(log) == 0;
+
+    if (!written && ftruncate(log, logSize) != 0) // a partly written record would shift all following ones
+        logPath.clear();
+    close(log);
+
+    if (!written)
+        return false;
+
+    logSize += sizeof(record);
+    writeIndex();
+    return true;
+}
+
+void CScoreStore::insert(int score, int level)
+{
+    std::pair<int, int> entry = {score, level};
+
+    // highest to lowest, equal scores keep the order they were reached in
+    auto position = std::upper_bound(top.begin(), top.end(), entry, std::greater<std::pair<int, int>>());
+    if (static_cast<size_t>(position - top.begin()) >= TOP_COUNT)
+        return;
+
+    top.insert(position, entry);
+    if (top.size() > TOP_COUNT)
+        top.pop_back();
+}
+
+const std::vector<std::pair<int, int>> &CScoreStore::getTop() const
+{
+    return top;
+}
+
+uint64_t CScoreStore::getCount() const
+{
+    return count;
+}
+
+uint32_t CScoreStore::getCheck(int32_t score, int32_t level)
+{
+    // 32-bit FNV-1a over the bytes of both values
+    uint32_t hash = 2166136261u;
+    int32_t values[2] = {score, level};
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(values);
+
+    for (size_t i = 0; i < sizeof(values); i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** \class CScoreRecord
+A single score in the score log.
+*/
+struct CScoreRecord
+{
+    int32_t score;  ///< the score
+    int32_t level;  ///< the level the game ended on
+    uint32_t check; ///< checksum of the score and the level, a record torn by a crash does not match it
+};
+
+/** \class CScoreStore
+The high scores: an append-only log of every score ever reached, and an index with the best TOP_COUNT of them.
+
+A score is appended to the log with a single write that is synced to the disk before add returns, so a crash loses at most the score being written.
+The best scores are kept sorted and bounded, a new score is inserted into them instead of sorting the whole history. They are saved to the index after every score,
+together with the size of the log they cover. Opening the store reads the index and only the part of the log written after it, which is nothing unless the game crashed
+between the two writes. The whole log is only read when the index is missing or broken.
+
+A store that was not opened keeps the best scores in memory only, e.g. in the headless simulations.
+*/
+class CScoreStore
+{
+public:
+    static constexpr size_t TOP_COUNT = 10; ///< number of the best scores kept in the index
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Opens the log and the index in a directory, creating them if they do not exist. The scores of the text file used by older versions (highscores.txt)
+    /// are moved to a new log.
+    ///
+    /// @param [in] directory the directory of the files
+    /// @return false if the log cannot be opened or created, the scores are then kept in memory only
+    bool open(const std::string &directory);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Adds a score. It is appended to the log if the store was opened.
+    ///
+    /// @param [in] score the score
+    /// @param [in] level the level the game ended on
+    /// @return false if the score could not be written, it is still counted in memory
+    bool add(int score, int level);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the best scores with their levels, sorted highest to lowest. At most TOP_COUNT of them.
+    const std::vector<std::pair<int, int>> &getTop() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the number of all scores, including those that are not among the best.
+    uint64_t getCount() const;
+
+private:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Inserts a score into the best scores if it is one of them.
+    ///
+    /// @param [in] score the score
+    /// @param [in] level the level the game ended on
+    void insert(int score, int level);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Reads the index.
+    ///
+    /// @return false if it is missing, broken or covers more than the log holds
+    bool readIndex();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Reads the records of the log written after the index was, inserts them into the best scores and cuts off a record torn by a crash.
+    ///
+    /// @return false if the log cannot be read
+    bool readLog();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Saves the best scores to the index. Written to a temporary file first, so that a crash leaves the previous index.
+    void writeIndex() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the checksum of a record.
+    ///
+    /// @param [in] score the score of the record
+    /// @param [in] level the level of the record
+    static uint32_t getCheck(int32_t score, int32_t level);
+
+    std::string logPath;                  ///< path to the log, empty if the store was not opened
+    std::string indexPath;                ///< path to the index
+    std::vector<std::pair<int, int>> top; ///< the best scores with their levels, sorted highest to lowest
+    uint64_t logSize = 0;                 ///< bytes of the log the best scores were taken from
+    uint64_t count = 0;                   ///< number of all scores added or read from the log
+};
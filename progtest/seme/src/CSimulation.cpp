@@ -0,0 +1,131 @@
+#include "CSimulation.h"
+
+#include "CGame.h"
+#include "CBot.h"
+#include "CRewindBuffer.h"
+#include "CAllocationTracker.h"
+
+#include <iostream>
+
+void CSimulation::prepare(CGameState &gamestate)
+{
+    if (!gamestate.distanceTable)
+        gamestate.distanceTable = CDistanceTable::load(gamestate.gameMap, "build");
+}
+
+CGameResult CSimulation::play(const CGameState &gamestate, unsigned int seed, CReplay *recording)
+{
+    CGame game;
+    game.gamestate = gamestate;
+    game.setup();
+    game.gamestate.screen = CGameState::CScreen::playing;
+
+    if (recording)
+    {
+        recording->begin(game.gamestate);
+        game.recorder = recording;
+    }
+
+    CBot bot(seed);
+    CGameResult result;
+
+    while (game.gamestate.screen == CGameState::CScreen::playing && result.time < TIME_LIMIT)
+    {
+        bot.update(game.gamestate);
+        game.step();
+        result.time += CGame::TICK;
+    }
+
+    if (recording)
+        recording->finish(game.gamestate);
+
+    result.score = game.gamestate.score;
+    result.level = game.gamestate.level;
+    result.over = game.gamestate.screen == CGameState::CScreen::gameOver;
+    return result;
+}
+
+CGameResult CSimulation::replay(const CGameState &gamestate, CReplay &replay)
+{
+    CGame game;
+    game.gamestate = gamestate;
+    game.setup();
+    game.gamestate.screen = CGameState::CScreen::playing;
+
+    CGameResult result;
+    replay.restart();
+
+    while (game.gamestate.screen == CGameState::CScreen::playing && replay.apply(game.gamestate))
+    {
+        game.step();
+        result.time += CGame::TICK;
+    }
+
+    result.score = game.gamestate.score;
+    result.level = game.gamestate.level;
+    result.over = game.gamestate.screen == CGameState::CScreen::gameOver;
+    return result;
+}
+
+CAllocationCheck CSimulation::checkAllocations(const CGameState &gamestate, unsigned int seed, int steps)
+{
+    CGame game;
+    game.gamestate = gamestate;
+    game.setup();
+    game.gamestate.screen = CGameState::CScreen::playing;
+    CPos start = game.gamestate.playerPos;
+
+    CReplay recording;
+    recording.begin(game.gamestate);
+    game.recorder = &recording;
+
+    CRewindBuffer rewind;
+    rewind.reserve(game);
+
+    CBot bot(seed);
+    CAllocationCheck result;
+
+    for (int step = 0; step < steps; step++)
+    {
+        int level = game.gamestate.level;
+        CGameState::CGameMode gamemode = game.gamestate.gamemode;
+
+        CAllocationTracker::beginFrame();
+        bot.update(game.gamestate);
+        game.step();
+        rewind.record(game);
+        size_t allocations = CAllocationTracker::endFrame();
+
+        // the step that ends the game saves the score, it is not a step of a running game
+        if (allocations > 0 && game.gamestate.screen == CGameState::CScreen::playing)
+        {
+            std::cout << "step " << step << " allocated " << allocations << " times:" << std::endl;
+            CAllocationTracker::report();
+            result.allocatingSteps++;
+        }
+
+        // a new level starts in the chase mode, only the modes changed within a level are counted
+        CGameState::CGameMode next = game.gamestate.gamemode;
+        if (game.gamestate.level != level)
+            result.levelChanges++;
+        else
+        {
+            result.powerUpsExpired += gamemode == CGameState::CGameMode::powerup && next != CGameState::CGameMode::powerup;
+            result.guardSwitches += (gamemode == CGameState::CGameMode::guard) != (next == CGameState::CGameMode::guard);
+        }
+
+        // the catch is undone like in svobov25-swarm, the score is never logged
+        if (game.gamestate.screen == CGameState::CScreen::gameOver)
+        {
+            game.gamestate.screen = CGameState::CScreen::playing;
+            game.gamestate.scorePending = false;
+            game.gamestate.playerPos = start;
+            game.gamestate.previousPlayerPos = start;
+            game.gamestate.thisMove = CDirection::none;
+            game.gamestate.nextMove = CDirection::none;
+            result.catches++;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "CGameState.h"
+#include "CReplay.h"
+
+/** \class CGameResult
+The outcome of a single headless game.
+*/
+struct CGameResult
+{
+    int score = 0;     ///< score at the end of the game
+    int level = 1;     ///< level at the end of the game
+    double time = 0;   ///< simulated seconds survived
+    bool over = false; ///< true if the player was caught, false if the time limit was reached
+};
+
+/** \class CAllocationCheck
+The outcome of CSimulation::checkAllocations: the steps that allocated and the changes of the game the checked steps went through.
+*/
+struct CAllocationCheck
+{
+    int allocatingSteps = 0; ///< number of steps that allocated
+    int levelChanges = 0;    ///< number of levels completed
+    int powerUpsExpired = 0; ///< number of power ups that ran out
+    int guardSwitches = 0;   ///< number of times the ghosts entered or left the guard mode
+    int catches = 0;         ///< number of times the player was caught and put back on its start tile
+};
+
+/** \class CSimulation
+Plays whole games without a window, the player is controlled by a CBot. Used by the headless tools.
+*/
+class CSimulation
+{
+public:
+    static constexpr double TIME_LIMIT = 600; ///< Seconds. Simulated time after which a game is stopped, so that a stuck bot does not run forever.
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Plays a whole game. It only reads the given gamestate, so games starting from the same one can be played on several threads at once.
+    ///
+    /// @param [in] gamestate the gamestate the game starts from, with the config already loaded
+    /// @param [in] seed seed of the bot
+    /// @param [out] recording if set, the game is recorded into it
+    static CGameResult play(const CGameState &gamestate, unsigned int seed, CReplay *recording = nullptr);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Plays a recorded game again, as fast as the CPU allows. It only reads the given gamestate, like play.
+    ///
+    /// @param [in] gamestate the gamestate the game starts from, configured by the replay
+    /// @param [in, out] replay the replay, played from its first step
+    static CGameResult replay(const CGameState &gamestate, CReplay &replay);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Plays a fixed number of steps like play, with everything the windowed game does on every step: the move is recorded and the rewind buffer is filled.
+    /// Every step of the running game is checked for heap allocations, the call sites of the allocating ones are printed.
+    ///
+    /// The bot rarely survives a level, so when the player is caught it is put back on its start tile and the game goes on. This way the steps
+    /// reach the level changes, the power ups running out and the switches of the guard mode, which a short game never gets to.
+    ///
+    /// @note Allocations are only seen in a build with TRACK_ALLOCATIONS, see CAllocationTracker.
+    ///
+    /// @param [in] gamestate the gamestate the game starts from, with the config already loaded
+    /// @param [in] seed seed of the bot
+    /// @param [in] steps number of steps played
+    static CAllocationCheck checkAllocations(const CGameState &gamestate, unsigned int seed, int steps);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Loads the distance table of a gamestate's map, so that copies of the gamestate share it instead of each loading their own.
+    ///
+    /// @param [in, out] gamestate a gamestate with the config already loaded
+    static void prepare(CGameState &gamestate);
+};
@@ -0,0 +1,92 @@
+#include "CSpriteBatch.h"
+
+constexpr int ATLAS_SIZE = 4;                     // the atlas only holds the solid sprite for now
+constexpr SDL_FPoint SOLID_SPRITE = {0.5f, 0.5f}; // texture coordinates of the solid sprite, the center of the atlas
+
+CSpriteBatch::CSpriteBatch(SDL_Renderer *renderer) : renderer(renderer)
+{
+    Uint32 pixels[ATLAS_SIZE * ATLAS_SIZE];
+    for (Uint32 &pixel : pixels)
+        pixel = 0xFFFFFFFF;
+
+    atlas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, ATLAS_SIZE, ATLAS_SIZE);
+    if (atlas != nullptr)
+    {
+        SDL_UpdateTexture(atlas, nullptr, pixels, ATLAS_SIZE * sizeof(Uint32));
+        SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+    }
+}
+
+CSpriteBatch::~CSpriteBatch()
+{
+    destroy();
+}
+
+void CSpriteBatch::destroy()
+{
+    if (atlas != nullptr)
+        SDL_DestroyTexture(atlas);
+    atlas = nullptr;
+}
+
+void CSpriteBatch::add(const SDL_Rect &rect, int R, int G, int B)
+{
+    const SDL_Color color = {static_cast<Uint8>(R), static_cast<Uint8>(G), static_cast<Uint8>(B), 255};
+    const float left = rect.x;
+    const float top = rect.y;
+    const float right = rect.x + rect.w;
+    const float bottom = rect.y + rect.h;
+    const int first = vertices.size();
+
+    vertices.push_back({{left, top}, color, SOLID_SPRITE});
+    vertices.push_back({{right, top}, color, SOLID_SPRITE});
+    vertices.push_back({{right, bottom}, color, SOLID_SPRITE});
+    vertices.push_back({{left, bottom}, color, SOLID_SPRITE});
+
+    for (int corner : {0, 1, 2, 0, 2, 3})
+        indices.push_back(first + corner);
+}
+
+void CSpriteBatch::flushRects()
+{
+    size_t quad = 0;
+    const size_t quadCount = vertices.size() / 4;
+
+    while (quad < quadCount)
+    {
+        const SDL_Color color = vertices[quad * 4].color;
+        rects.clear();
+
+        for (; quad < quadCount; quad++)
+        {
+            const SDL_Vertex &topLeft = vertices[quad * 4];
+            const SDL_Vertex &bottomRight = vertices[quad * 4 + 2];
+            if (topLeft.color.r != color.r || topLeft.color.g != color.g || topLeft.color.b != color.b)
+                break;
+
+            rects.push_back({static_cast<int>(topLeft.position.x),
+                             static_cast<int>(topLeft.position.y),
+                             static_cast<int>(bottomRight.position.x - topLeft.position.x),
+                             static_cast<int>(bottomRight.position.y - topLeft.position.y)});
+        }
+
+        SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+        SDL_RenderFillRects(renderer, rects.data(), rects.size());
+    }
+}
+
+void CSpriteBatch::flush()
+{
+    if (vertices.empty())
+        return;
+
+    if (atlas == nullptr || geometryFailed ||
+        SDL_RenderGeometry(renderer, atlas, vertices.data(), vertices.size(), indices.data(), indices.size()) != 0)
+    {
+        geometryFailed = true;
+        flushRects();
+    }
+
+    vertices.clear();
+    indices.clear();
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <vector>
+
+/** \class CSpriteBatch
+Collects the quads of a frame and submits them to the renderer in as few draw calls as possible.
+
+All quads are sprites from a single atlas texture tinted by their vertex colors, so a whole batch is one SDL_RenderGeometry call.
+If the renderer cannot draw geometry, the quads are submitted with one SDL_RenderFillRects call per run of equal colors instead.
+The buffers are kept between frames, so a batch does not allocate once it has grown to the size of a frame.
+*/
+class CSpriteBatch
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Constructor that creates the sprite atlas
+    ///
+    /// @param [in] renderer pointer to the SDL_Renderer
+    CSpriteBatch(SDL_Renderer *renderer);
+    CSpriteBatch(const CSpriteBatch &) = delete;
+    CSpriteBatch &operator=(const CSpriteBatch &) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Destroys the atlas
+    ~CSpriteBatch();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Destroys the atlas. Has to be called before the renderer is destroyed.
+    void destroy();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Adds a solid quad to the batch.
+    ///
+    /// @param [in] rect the quad in pixels
+    /// @param [in] R red
+    /// @param [in] G green
+    /// @param [in] B blue
+    void add(const SDL_Rect &rect, int R, int G, int B);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Draws all quads added since the last flush to the current render target and empties the batch.
+    void flush();
+
+private:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Draws the batch with one SDL_RenderFillRects call per run of equal colors.
+    void flushRects();
+
+    SDL_Renderer *renderer;           ///< the renderer that is drawn with
+    SDL_Texture *atlas = nullptr;     ///< the sprite atlas, nullptr if it could not be created
+    bool geometryFailed = false;      ///< true if SDL_RenderGeometry failed, the rect fallback is used from then on
+    std::vector<SDL_Vertex> vertices; ///< four vertices per quad
+    std::vector<int> indices;         ///< six indices per quad
+    std::vector<SDL_Rect> rects;      ///< scratch buffer of the rect fallback
+};
@@ -0,0 +1,139 @@
+#include "CTextCache.h"
+
+#include <algorithm>
+
+CTextCache::CTextCache(SDL_Renderer *renderer, TTF_Font *font) : renderer(renderer), font(font)
+{
+    buildAtlas();
+}
+
+CTextCache::~CTextCache()
+{
+    destroy();
+}
+
+void CTextCache::destroy()
+{
+    for (auto &text : texts)
+        SDL_DestroyTexture(text.second.texture);
+    texts.clear();
+
+    if (atlas != nullptr)
+        SDL_DestroyTexture(atlas);
+    atlas = nullptr;
+}
+
+void CTextCache::buildAtlas()
+{
+    const SDL_Color textColor = {255, 255, 255, 255};
+    const int glyphCount = LAST_GLYPH - FIRST_GLYPH + 1;
+
+    SDL_Surface *glyphSurfaces[glyphCount];
+    int cellWidth = 1;
+    int cellHeight = 1;
+
+    for (int i = 0; i < glyphCount; i++)
+    {
+        glyphSurfaces[i] = TTF_RenderGlyph_Solid(font, FIRST_GLYPH + i, textColor);
+
+        int minX, maxX, minY, maxY, advance = 0;
+        TTF_GlyphMetrics(font, FIRST_GLYPH + i, &minX, &maxX, &minY, &maxY, &advance);
+        glyphs[i].advance = advance;
+        glyphs[i].source = {0, 0, 0, 0};
+
+        if (glyphSurfaces[i] != nullptr)
+        {
+            cellWidth = std::max(cellWidth, glyphSurfaces[i]->w);
+            cellHeight = std::max(cellHeight, glyphSurfaces[i]->h);
+        }
+    }
+
+    const int rows = (glyphCount + GLYPHS_PER_ROW - 1) / GLYPHS_PER_ROW;
+    SDL_Surface *atlasSurface = SDL_CreateRGBSurfaceWithFormat(0, cellWidth * GLYPHS_PER_ROW, cellHeight * rows, 32, SDL_PIXELFORMAT_RGBA32);
+
+    for (int i = 0; i < glyphCount; i++)
+    {
+        if (glyphSurfaces[i] == nullptr)
+            continue;
+
+        SDL_Rect cell = {(i % GLYPHS_PER_ROW) * cellWidth, (i / GLYPHS_PER_ROW) * cellHeight, glyphSurfaces[i]->w, glyphSurfaces[i]->h};
+        glyphs[i].source = cell;
+
+        if (atlasSurface != nullptr)
+            SDL_BlitSurface(glyphSurfaces[i], nullptr, atlasSurface, &cell);
+        SDL_FreeSurface(glyphSurfaces[i]);
+    }
+
+    if (atlasSurface != nullptr)
+    {
+        atlas = SDL_CreateTextureFromSurface(renderer, atlasSurface);
+        SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+        SDL_FreeSurface(atlasSurface);
+    }
+}
+
+void CTextCache::drawStatic(std::string_view text, int x, int y)
+{
+    auto cached = texts.find(text);
+    if (cached == texts.end())
+    {
+        // the first use of this string, it is rasterized and kept
+        const SDL_Color textColor = {255, 255, 255, 255};
+        std::string key(text);
+        CText rendered;
+
+        SDL_Surface *textSurface = TTF_RenderText_Solid(font, key.c_str(), textColor);
+        if (textSurface != nullptr)
+        {
+            // Drawing a texture instead of a surface is arguably faster, as a texture is stored in the VRAM.
+            rendered.texture = SDL_CreateTextureFromSurface(renderer, textSurface);
+            rendered.width = textSurface->w;
+            rendered.height = textSurface->h;
+            SDL_FreeSurface(textSurface);
+        }
+
+        cached = texts.emplace(std::move(key), rendered).first;
+    }
+
+    const CText &rendered = cached->second;
+    if (rendered.texture == nullptr)
+        return;
+
+    SDL_Rect dst = {
+        x - rendered.width / 2,
+        y - rendered.height / 2,
+        rendered.width,
+        rendered.height};
+    SDL_RenderCopy(renderer, rendered.texture, NULL, &dst);
+}
+
+void CTextCache::drawComposed(std::string_view text, int x, int y)
+{
+    if (atlas == nullptr)
+        return;
+
+    int textWidth = 0;
+    int textHeight = 0;
+    for (char c : text)
+        if (c >= FIRST_GLYPH && c <= LAST_GLYPH)
+        {
+            textWidth += glyphs[c - FIRST_GLYPH].advance;
+            textHeight = std::max(textHeight, glyphs[c - FIRST_GLYPH].source.h);
+        }
+
+    int penX = x - textWidth / 2;
+    const int top = y - textHeight / 2;
+
+    for (char c : text)
+    {
+        if (c < FIRST_GLYPH || c > LAST_GLYPH)
+            continue;
+
+        const CGlyph &glyph = glyphs[c - FIRST_GLYPH];
+        SDL_Rect dst = {penX, top, glyph.source.w, glyph.source.h};
+        if (glyph.source.w > 0)
+            SDL_RenderCopy(renderer, atlas, &glyph.source, &dst);
+
+        penX += glyph.advance;
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <map>
+#include <string>
+#include <string_view>
+
+/** \class CTextCache
+Caches rendered text, so that a frame with unchanged text does no font rasterization and creates no textures.
+
+Static strings are rasterized once, on their first use, and kept as textures. Text that changes (numbers) is composed from a glyph atlas
+that holds every printable ASCII character and is built when the cache is created.
+*/
+class CTextCache
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Constructor that builds the glyph atlas
+    ///
+    /// @param [in] renderer pointer to the SDL_Renderer
+    /// @param [in] font pointer to a TTF_Font. It has to stay open while the cache is used.
+    CTextCache(SDL_Renderer *renderer, TTF_Font *font);
+    CTextCache(const CTextCache &) = delete;
+    CTextCache &operator=(const CTextCache &) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Destroys all textures
+    ~CTextCache();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Destroys all textures. Has to be called before the renderer is destroyed.
+    void destroy();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Draws a string that does not change. It is rasterized on the first call only.
+    ///
+    /// @note The text is centered around the coordinates.
+    ///
+    /// @param [in] text the text
+    /// @param [in] x The x coordinate
+    /// @param [in] y The y coordinate
+    void drawStatic(std::string_view text, int x, int y);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Draws a string that changes often, composed glyph by glyph from the atlas. Characters that are not printable ASCII are skipped.
+    ///
+    /// @note The text is centered around the coordinates.
+    ///
+    /// @param [in] text the text
+    /// @param [in] x The x coordinate
+    /// @param [in] y The y coordinate
+    void drawComposed(std::string_view text, int x, int y);
+
+private:
+    static constexpr char FIRST_GLYPH = ' ';  ///< first character in the atlas
+    static constexpr char LAST_GLYPH = '~';   ///< last character in the atlas
+    static constexpr int GLYPHS_PER_ROW = 16; ///< the atlas is packed into rows, so that it stays narrow
+
+    /** \class CGlyph
+    Position of a character in the atlas.
+    */
+    struct CGlyph
+    {
+        SDL_Rect source; ///< rectangle of the glyph in the atlas
+        int advance = 0; ///< horizontal distance to the next glyph
+    };
+
+    /** \class CText
+    A rasterized static string.
+    */
+    struct CText
+    {
+        SDL_Texture *texture = nullptr; ///< the rendered text, nullptr if rendering failed
+        int width = 0;                  ///< width in pixels
+        int height = 0;                 ///< height in pixels
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Rasterizes every glyph and packs them into the atlas texture.
+    void buildAtlas();
+
+    SDL_Renderer *renderer;                          ///< the renderer that is drawn with
+    TTF_Font *font;                                  ///< the font the text is rasterized with
+    SDL_Texture *atlas = nullptr;                    ///< the glyph atlas, nullptr if it could not be built
+    CGlyph glyphs[LAST_GLYPH - FIRST_GLYPH + 1];     ///< glyphs of the atlas, indexed from FIRST_GLYPH
+    std::map<std::string, CText, std::less<>> texts; ///< static strings, looked up without building a std::string
+};
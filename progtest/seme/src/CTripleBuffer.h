@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/** \class CTripleBuffer
+Hands the newest value from a single writer thread to a single reader thread without locks, e.g. the state of every step from the simulation to the renderer.
+
+Of the three slots, one belongs to the writer, one to the reader and the third one holds the value published last. Publishing swaps the writer's slot with the third one,
+taking the newest value swaps the reader's slot with it. The swaps are a single atomic exchange each, so neither thread ever waits for the other.
+The writer can publish many values while the reader holds one, the values in between are dropped. The slots are never reallocated, a value that reuses its memory
+when it is overwritten (like a vector that keeps its capacity) is published without allocating.
+*/
+template <class T>
+class CTripleBuffer
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the writer's slot. It holds the value the writer published two times ago, or the initial value. Only the writer thread may call this.
+    T &getWriteBuffer() { return buffers[writeSlot]; }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Publishes the value in the writer's slot. The writer gets another slot to write the next value to. Only the writer thread may call this.
+    void publish()
+    {
+        writeSlot = middle.exchange(writeSlot | FRESH, std::memory_order_acq_rel) & SLOT;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Moves the value published last to the reader's slot, if it was not taken yet. Only the reader thread may call this.
+    ///
+    /// @return true if the reader's slot holds a new value
+    bool update()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH))
+            return false;
+
+        readSlot = middle.exchange(readSlot, std::memory_order_acq_rel) & SLOT;
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the reader's slot, the value taken by the last update. Only the reader thread may call this.
+    const T &getReadBuffer() const { return buffers[readSlot]; }
+
+private:
+    static constexpr uint8_t SLOT = 3;  ///< the bits of middle holding the index of the slot
+    static constexpr uint8_t FRESH = 4; ///< the bit of middle set when its slot was published and not taken by the reader yet
+
+    T buffers[3];                    ///< the slots
+    std::atomic<uint8_t> middle = 1; ///< index of the slot published last, together with the FRESH bit
+    uint8_t writeSlot = 0;           ///< index of the writer's slot
+    uint8_t readSlot = 2;            ///< index of the reader's slot
+};
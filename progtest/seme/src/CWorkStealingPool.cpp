@@ -0,0 +1,80 @@
+#include "CWorkStealingPool.h"
+
+#include <algorithm>
+#include <thread>
+
+CWorkStealingPool::CWorkStealingPool(unsigned int threadCount) : threadCount(threadCount)
+{
+    if (this->threadCount == 0)
+        this->threadCount = std::max(1u, std::thread::hardware_concurrency());
+}
+
+unsigned int CWorkStealingPool::getThreadCount() const
+{
+    return threadCount;
+}
+
+bool CWorkStealingPool::pop(unsigned int worker, size_t &taskIndex)
+{
+    CQueue &queue = queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (queue.tasks.empty())
+        return false;
+
+    taskIndex = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool CWorkStealingPool::steal(unsigned int worker, size_t &taskIndex)
+{
+    // victims are tried starting with the next worker, so that the thieves do not all queue up on the same one
+    for (unsigned int i = 1; i < threadCount; i++)
+    {
+        CQueue &queue = queues[(worker + i) % threadCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (!queue.tasks.empty())
+        {
+            taskIndex = queue.tasks.front();
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void CWorkStealingPool::work(unsigned int worker, const std::function<void(size_t)> &task)
+{
+    size_t taskIndex;
+
+    // tasks never create new tasks, so once every queue was seen empty there is nothing left to do
+    while (pop(worker, taskIndex) || steal(worker, taskIndex))
+        task(taskIndex);
+}
+
+void CWorkStealingPool::run(size_t taskCount, const std::function<void(size_t)> &task)
+{
+    queues = std::vector<CQueue>(threadCount);
+
+    for (unsigned int worker = 0; worker < threadCount; worker++)
+    {
+        size_t begin = taskCount * worker / threadCount;
+        size_t end = taskCount * (worker + 1) / threadCount;
+
+        // reversed, so that the owner takes its block front to back from the back of the queue
+        for (size_t taskIndex = end; taskIndex > begin; taskIndex--)
+            queues[worker].tasks.push_back(taskIndex - 1);
+    }
+
+    std::vector<std::thread> threads;
+    for (unsigned int worker = 1; worker < threadCount; worker++)
+        threads.emplace_back(&CWorkStealingPool::work, this, worker, std::cref(task));
+
+    work(0, task);
+
+    for (std::thread &thread : threads)
+        thread.join();
+}
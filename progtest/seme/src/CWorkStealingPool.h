@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/** \class CWorkStealingPool
+Runs a batch of independent tasks on all cores.
+
+Every worker gets its own queue holding a contiguous block of the task indices and takes tasks from its back.
+A worker that runs out of tasks steals from the front of the other queues, so a block of slow tasks does not leave the other cores idle.
+*/
+class CWorkStealingPool
+{
+public:
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Constructor that sets the number of workers.
+    ///
+    /// @param [in] threadCount number of workers, 0 to use one per hardware thread
+    CWorkStealingPool(unsigned int threadCount = 0);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Runs task(0) ... task(taskCount - 1) and returns when all of them finished. The calling thread is one of the workers.
+    ///
+    /// @param [in] taskCount number of tasks
+    /// @param [in] task the task, called with the index of the task. It is called from several threads at once.
+    void run(size_t taskCount, const std::function<void(size_t)> &task);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Returns the number of workers.
+    unsigned int getThreadCount() const;
+
+private:
+    /** \class CQueue
+    Task indices of a single worker.
+    */
+    struct CQueue
+    {
+        std::mutex mutex;         ///< guards the tasks
+        std::deque<size_t> tasks; ///< indices of the tasks not taken yet
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Runs tasks until there are none left in any of the queues.
+    ///
+    /// @param [in] worker index of the worker
+    /// @param [in] task the task
+    void work(unsigned int worker, const std::function<void(size_t)> &task);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Takes a task from the back of the worker's own queue.
+    ///
+    /// @param [in] worker index of the worker
+    /// @param [out] taskIndex the task taken
+    /// @return false if the queue is empty
+    bool pop(unsigned int worker, size_t &taskIndex);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Takes a task from the front of another worker's queue.
+    ///
+    /// @param [in] worker index of the worker that steals
+    /// @param [out] taskIndex the task taken
+    /// @return false if all of the other queues are empty
+    bool steal(unsigned int worker, size_t &taskIndex);
+
+    unsigned int threadCount;   ///< number of workers
+    std::vector<CQueue> queues; ///< one queue per worker
+};
@@ -0,0 +1,33 @@
+#include <iostream>
+#include <string>
+
+#include "CGameState.h"
+#include "CLevelFile.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compiles a text config into a binary level file, which the game and the headless tools map instead of parsing.
+///
+/// Usage: svobov25-compile config level
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        std::cout << "Usage: svobov25-compile config level" << std::endl;
+        return 1;
+    }
+
+    CGameState gamestate;
+    if (!gamestate.loadConfig(argv[1]))
+        return 1; // the reason was already printed, the defaults are not compiled in its place
+
+    if (!CLevelFile::write(gamestate, argv[2]))
+    {
+        std::cout << "Error writing level file " << argv[2] << "." << std::endl;
+        return 1;
+    }
+
+    std::cout << "compiled " << gamestate.gameMap.BOARDWIDTH << "x" << gamestate.gameMap.BOARDHEIGHT
+              << " board with " << gamestate.gameMap.getEntityCount() << " entities to " << argv[2] << std::endl;
+
+    return 0;
+}
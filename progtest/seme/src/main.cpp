@@ -1,16 +1,34 @@
 #include <cstdlib>
+#include <cstdio>
 #include <vector>
 #include <memory>
 #include <iostream>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <fstream>
-
-#include "CMax.h"
-#include "CManhattan.h"
-#include "CEuclid.h"
-#include "CCoin.h"
-#include "CPowerUp.h"
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <iterator>
+
+#include "CGame.h"
+#include "CSDLCanvas.h"
+#include "CCamera.h"
+#include "CBoardLayer.h"
+#include "CTextCache.h"
+#include "CProfiler.h"
+#include "CInputQueue.h"
+#include "CFramePacer.h"
+#include "CRewindBuffer.h"
+#include "CReplay.h"
+#include "CAllocationTracker.h"
+#include "CRenderState.h"
+#include "CTripleBuffer.h"
+#include "CMailbox.h"
+
+constexpr int ALLOCATION_WARMUP_FRAMES = 60; // the first frames of a game may still grow the buffers of the renderer, they are not checked
 
 /*! \mainpage About the project
  *
@@ -20,7 +38,8 @@
  * \n
  * It is a simple PAC-MAN recreation. True to the original game, the individual ghosts all have different pathfinding algorithms. \n
  * They pick the player's position as a target (contrary to the original game, where this differed for individual ghosts) and use \n
- * different vector norms to calculate the optimal path. \n
+ * different vector norms to calculate the optimal path. When the map is small enough, the ghosts measure real distances through the maze \n
+ * instead (CDistanceTable, precomputed on load and cached in the build directory) and their norms only break ties. \n
  * \n
  * Three gamemodes are present. Chase, that is the default, when the player is being chased by the ghosts. Power-up, which occurs when \n
  * the player eats one of the power pellets and can then eat the ghosts, who turn blue. And finally, guard, when the ghosts stop following \n
@@ -31,8 +50,48 @@
  * While playing, the game is controlled with the arrow keys. \n
  * When a game is over, the user is prompted to play again (space), or enter the leaderboards (h). \n
  * In the leaderboard screen, the user can go back by pressing (h) again. \n
+ * Every score is appended to build/scores.log when the game over screen is left (or the game is closed on it), the best ten are kept in build/scores.idx (CScoreStore). \n
+ * \n
+ * To exit, press the (esc) key. \n
+ * \n
+ * (F3) toggles the profiler overlay with the frame time percentiles, a sparkline of the recent frames and the time of every phase of a frame (CProfiler). \n
+ * The times of the last frames are written to build/frametimes.csv on exit. \n
+ * \n
+ * Holding (backspace) rewinds the last 5 seconds of the game, also right after the player was caught, until the game over screen is left (CRewindBuffer). \n
+ * (F5) saves the game to build/savegame.bin and (F9) loads it again, as long as the same map is played (CGameSnapshot). \n
+ * \n
+ * By default, frames are synchronized with the display (vsync). ./svobov25 cap [fps] limits the frame rate by sleeping instead (60 frames per second if not given)
+ * and ./svobov25 uncapped draws as many frames as possible. While no game is being played, frames are only drawn when a key is pressed.
+ * \n
+ * The game runs on a thread of its own, at the pace of its fixed steps. After its steps it publishes what is drawn (CRenderState) through a triple buffer (CTripleBuffer),
+ * and the window draws the newest published state, interpolated up to the present. Neither thread waits for the other, so a slow frame (the display, the text)
+ * does not hold the game back. The keys are passed to the game thread through a mailbox (CMailbox). \n
+ * \n
+ * Every game is recorded (CReplay) and written to build/replay.bin when it is over. ./svobov25 replay file plays a recording again in the window,
+ * the arrow keys and rewinding are ignored then.
+ *
+ * \section sim_sec Headless simulation
+ *
+ * The simulation (CGame and everything it owns) does not depend on SDL and is built as a separate library. \n
+ * Besides the game itself, it is linked into svobov25-sim, which plays whole games without a window as fast as the CPU allows. \n
+ * The player is then controlled by a scripted bot (CBot). Usage: ./svobov25-sim [-e] [games] [seed] [config] [replay directory] \n
+ * With -e, the games are played by CEventSimulation, which only takes the steps in which the bot or a ghost decides something, a mode timer expires
+ * or the player meets a ghost, and skips all the others at once. The results are the same, the number of the steps taken is printed. \n
+ * \n
+ * svobov25-sweep tunes the config constants. It plays many games for every combination of the values listed in a parameter grid (see src/sweep.conf) on every given map,
+ * spreads them over all cores (CWorkStealingPool) and writes the score, level and survival time distributions of every combination to a CSV file. \n
+ * Usage: ./svobov25-sweep [-j threads] grid games output [map config ...] \n
+ * \n
+ * svobov25-replay plays recorded games as fast as the CPU allows and checks that each one ends with the recorded score and level, so a corpus of replays serves
+ * as a regression test and a benchmark of the simulation. svobov25-sim can record the games of its bot to start one. \n
+ * Usage: ./svobov25-replay config replay [replay ...] \n
  * \n
- * To exit, press the (esc) key.
+ * svobov25-swarm measures how the update of the ghosts scales from 3 to 10000 of them. The start tiles spawn larger and larger swarms (SPAWN_COUNT),
+ * the bot plays on and the update time per step and per ghost is written as CSV. Collisions with the player only look at the ghosts on the player's tile (CGhostGrid). \n
+ * Usage: ./svobov25-swarm [steps] [config] \n
+ * \n
+ * make allocdebug builds svobov25-allocdebug and svobov25-sim-allocdebug, which count the heap allocations of every frame and of every pass of the game thread (CAllocationTracker).
+ * Once a game has run for a second, every frame or pass that allocates is printed with its call sites and the game exits with an error. svobov25-sim-allocdebug checks every step of one more game. \n
  *
  * \section conf_sec Config files
  *
@@ -47,12 +106,16 @@
  * TIME_BETWEEN_GUARD_MODE: Seconds \n
  * INITIAL_GUARD_TIME: Seconds \n
  * GUARD_TIME_DECREMENT: Seconds, decrement on level increase \n
- * WINDOW_SCALE Window scale * board width is the window width in pixels. Same goes for height. \n
+ * SPAWN_COUNT: Optional, ghosts spawned by every ghost start tile (1 if not given, at most 65536). The ghosts beyond the first one start on the walkable tiles nearest to it. \n
+ * WINDOW_SCALE Window scale * board width is the window width in pixels. Same goes for height. Boards larger than 40 tiles scroll, the window shows 40 tiles around the player. \n
  * BOTTOM_PADDING In pixels \n
  * FONT_SIZE \n
- * BOARD_WIDTH Needed to correctly load the game board \n
- * BOARD_HEIGHT Needed to correctly load the game board \n
+ * BOARD_WIDTH Needed to correctly load the game board, at most 4096 \n
+ * BOARD_HEIGHT Needed to correctly load the game board, at most 4096 \n
  * BOARD Game board \n
+ * \n
+ * A config can be compiled into a binary level file with ./svobov25-compile config level (CLevelFile). Wherever a config file is accepted, a level file can be
+ * given instead. It is mapped into memory and used without parsing, which makes loading large maps much faster. \n
  *
  * \section sources_sec Sources
  *
@@ -68,7 +131,8 @@
 ///
 /// @param [in] renderer the renderer that will be initialized
 /// @param [in] window the window that will be initialized
-void initializeWindow(CGameState &gamestate, SDL_Renderer *&renderer, SDL_Window *&window)
+/// @param [in] vsync true if SDL_RenderPresent should wait for the display
+void initializeWindow(CGameState &gamestate, SDL_Renderer *&renderer, SDL_Window *&window, bool vsync)
 {
     if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
         std::cout << "Error initializing SDL." << std::endl;
@@ -84,7 +148,7 @@ void initializeWindow(CGameState &gamestate, SDL_Renderer *&renderer, SDL_Window
         gamestate.WINDOW_HEIGHT + gamestate.BOTTOM_PADDING,
         SDL_WINDOW_BORDERLESS);
 
-    renderer = SDL_CreateRenderer(window, -1, 0);
+    renderer = SDL_CreateRenderer(window, -1, vsync ? SDL_RENDERER_PRESENTVSYNC : 0);
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
 }
 
@@ -121,136 +185,59 @@ void closeFont(TTF_Font *font)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Loads high scores from a external file to a gamestate instance.
+/// Opens the high score store in the build directory. Only the index of the best scores is read, every score is then written when its game over screen is left.
 ///
 /// @param [out] gamestate a gamestate instance to be loaded to
 void loadHighScores(CGameState &gamestate)
 {
-    std::string score;
-    std::string level;
-    std::ifstream highscores("build/highscores.txt");
-    if (highscores.is_open())
-    {
-        while (getline(highscores, score, ';') && getline(highscores, level))
-        {
-            gamestate.highscores.push_back({atoi(score.c_str()), atoi(level.c_str())});
-        }
-        highscores.close();
-    }
-    else
+    if (!gamestate.highscores.open("build"))
         std::cout << "An error occured while loading highscores";
 }
 
-////////////////////////////////////////////////////////////////////////////////
-/// Saves the high scores that are held in the gamestate to an external file.
-///
-/// @param [in] gamestate a gamestate instance holding the high scores
-void saveHighScores(CGameState &gamestate)
-{
-    std::ofstream highscores("build/highscores.txt");
-    if (highscores.is_open())
-    {
-        highscores.clear();
-
-        for (auto score : gamestate.highscores)
-            highscores << score.first << ";" << score.second << std::endl;
-    }
-    else
-        std::cout << "An error occured while saving highscores";
-}
-
-////////////////////////////////////////////////////////////////////////////////
-/// Loads game objects from the game board stored in the gamestate instance
-///
-/// @note This function also initializes the player position and coin count in the gamestate instance
-///
-/// @param [in] gamestate A gamestate instance that holds the game board
-/// @param [out] gameObjects a vector of game objects that will be filled
-void loadGameObjects(CGameState &gamestate, std::vector<std::unique_ptr<CGameObject>> &gameObjects)
-{
-    int coinCount = 0;
-
-    for (int i = 0; i < gamestate.gameMap.BOARDHEIGHT; i++)
-        for (int j = 0; j < gamestate.gameMap.BOARDWIDTH; j++)
-
-            switch (gamestate.gameMap.map[i][j])
-            {
-            case (gamestate.gameMap.CMapObjects::C):
-                coinCount++;
-                gameObjects.insert(gameObjects.begin(), std::unique_ptr<CGameObject>(new CCoin(CPos(j, i)))); // we insert to front because we want the ghosts to be rendered on top
-                break;
-            case (gamestate.gameMap.CMapObjects::P):
-                gameObjects.insert(gameObjects.begin(), std::unique_ptr<CGameObject>(new CPowerUp(CPos(j, i))));
-                break;
-            case (gamestate.gameMap.CMapObjects::S):
-                gamestate.playerPos = CPos(j, i);
-                break;
-            case (gamestate.gameMap.CMapObjects::m):
-                gameObjects.push_back(std::unique_ptr<CGameObject>(new CMax(CPos(j, i))));
-                break;
-            case (gamestate.gameMap.CMapObjects::t):
-                gameObjects.push_back(std::unique_ptr<CGameObject>(new CManhattan(CPos(j, i))));
-                break;
-            case (gamestate.gameMap.CMapObjects::e):
-                gameObjects.push_back(std::unique_ptr<CGameObject>(new CEuclid(CPos(j, i))));
-                break;
-            }
-
-    gamestate.gameMap.coinCount = coinCount;
-}
-
-////////////////////////////////////////////////////////////////////////////////
-/// Initializes game objects and other gamestate variables. Called once before the game loop starts and then on every level increase.
-///
-/// @param [out] gamestate a gamestate instance
-/// @param [out] gameObject a vector of unique pointers to game objects. Polymorphism applied here.
-void setup(CGameState &gamestate, std::vector<std::unique_ptr<CGameObject>> &gameObjects)
-{
-    std::vector<CPos> teleportPositions;
-    loadGameObjects(gamestate, gameObjects);
-
-    gamestate.nextMove = CDirection::none;
-    gamestate.thisMove = CDirection::none;
-    gamestate.nextGuard = gamestate.TIME_BETWEEN_GUARD_MODE;
-    gamestate.guardTimeRemaining = 0;
-    gamestate.gamemode = CGameState::CGameMode::chase;
-}
-
 ////////////////////////////////////////////////////////////////////////////////
 /// Handles user input while the game is being played. Checks for arrow keys input.
 ///
-/// @param [out] gamestate a gamestate instance
+/// @note The moves are not applied here, they are queued and applied by update before the step that starts after the key press.
+///
+/// @param [out] input the queue of moves
 /// @param [in] event the SDL_Event that is being processed in the wrapper function
-void processInputPlayingScreen(CGameState &gamestate, const SDL_Event &event)
+/// @param [in] time when the key was pressed
+void processInputPlayingScreen(CInputQueue &input, const SDL_Event &event, CInputQueue::CTime time)
 {
     if (event.key.keysym.sym == SDLK_UP)
-        gamestate.nextMove = CDirection::up;
+        input.push(CDirection::up, time);
     else if (event.key.keysym.sym == SDLK_DOWN)
-        gamestate.nextMove = CDirection::down;
+        input.push(CDirection::down, time);
     else if (event.key.keysym.sym == SDLK_LEFT)
-        gamestate.nextMove = CDirection::left;
+        input.push(CDirection::left, time);
     else if (event.key.keysym.sym == SDLK_RIGHT)
-        gamestate.nextMove = CDirection::right;
+        input.push(CDirection::right, time);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Handles user input while in the game over screen. Checks if the player wants to play (space), or view the scoreboard (h).
 ///
-/// @param [out] gamestate a gamestate instance
+/// Leaving the screen either way logs the score. The game cannot be rewound anymore afterwards, so it cannot be lost and logged a second time.
+///
+/// @param [out] game a game instance, restarted if the player wants to play again
+/// @param [out] rewind the rewind buffer, cleared when the screen is left
 /// @param [in] event the SDL_Event that is being processed in the wrapper function
-void processInputGameOverScreen(CGameState &gamestate, std::vector<std::unique_ptr<CGameObject>> &gameObjects, const SDL_Event &event)
+void processInputGameOverScreen(CGame &game, CRewindBuffer &rewind, const SDL_Event &event)
 {
+    if (event.key.keysym.sym != SDLK_SPACE && event.key.keysym.sym != SDLK_h)
+        return;
+
+    game.gamestate.saveScore();
+    rewind.clear();
+
     if (event.key.keysym.sym == SDLK_SPACE)
     {
-        gameObjects.clear();
-        gamestate.score = 0;
-        gamestate.level = 1;
-        setup(gamestate, gameObjects);
-        gamestate.screen = CGameState::CScreen::playing;
+        game.restart();
+        game.gamestate.screen = CGameState::CScreen::playing;
     }
-    else if (event.key.keysym.sym == SDLK_h)
+    else
     {
-        gamestate.screen = CGameState::CScreen::scoreBoard;
+        game.gamestate.screen = CGameState::CScreen::scoreBoard;
     }
 }
 
@@ -268,274 +255,333 @@ void processInputScoreBoardScreen(CGameState &gamestate, const SDL_Event &event)
 ////////////////////////////////////////////////////////////////////////////////
 /// A wrapper function that processes key input and calls the corresponding screen handler.
 ///
-/// @param [out] gamestate a gamestate instance
-/// @param [out] gameObjects a gameObjects vector, cleared/loaded if the game is restarted/started
-/// @param [out] playing a boolean that keeps the game loop running
+/// @param [out] game a game instance, restarted if the player wants to play again
+/// @param [out] input the queue of moves
+/// @param [out] rewind the rewind buffer
 /// @param [in] event the SDL_Event that is being processed in the wrapper function
-void handleKeyDown(CGameState &gamestate, std::vector<std::unique_ptr<CGameObject>> &gameObjects, bool &playing, const SDL_Event &event)
+/// @param [in] time when the key was pressed
+void handleKeyDown(CGame &game, CInputQueue &input, CRewindBuffer &rewind, const SDL_Event &event, CInputQueue::CTime time)
 {
+    CGameState &gamestate = game.gamestate;
+
     if (gamestate.screen == CGameState::CScreen::start)
         gamestate.screen = CGameState::CScreen::playing;
 
     if (gamestate.screen == CGameState::CScreen::playing) // not including this in an else block allows the first arrow key press to be registered
-        processInputPlayingScreen(gamestate, event);
+        processInputPlayingScreen(input, event, time);
 
     else if (gamestate.screen == CGameState::CScreen::gameOver)
-        processInputGameOverScreen(gamestate, gameObjects, event);
+        processInputGameOverScreen(game, rewind, event);
 
     else if (gamestate.screen == CGameState::CScreen::scoreBoard)
         processInputScoreBoardScreen(gamestate, event);
-
-    if (event.key.keysym.sym == SDLK_ESCAPE) // break the game cycle
-        playing = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// A wrapper function that checks for a quit event or a key down event and calls the key down event handler (handleKeyDown)
+/// Saves the game to build/savegame.bin, together with a hash of the map.
 ///
-/// @param [out] gamestate a gamestate instance
-/// @param [out] gameObjects a gameObjects vector, cleared/loaded if the game is restarted/started
-/// @param [in] playing a boolean that keeps the game loop running
-void processInput(CGameState &gamestate, std::vector<std::unique_ptr<CGameObject>> &gameObjects, bool &playing)
+/// @param [in] game a game instance
+void saveGame(const CGame &game)
 {
-    SDL_Event event;
-    SDL_PollEvent(&event);
-
-    switch (event.type)
-    {
-    case (SDL_QUIT):
-        playing = false;
-        break;
+    CGameSnapshot snapshot;
+    game.saveState(snapshot);
 
-    case (SDL_KEYDOWN):
-        handleKeyDown(gamestate, gameObjects, playing, event);
-        break;
-    }
+    if (!snapshot.writeFile("build/savegame.bin", CDistanceTable::hashMap(game.gamestate.gameMap)))
+        std::cout << "Error saving the game." << std::endl;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Called when the player reaches the next level. It increases difficulty by decrementing power up and guard times in the gamestate and re-loads game objects.
+/// Loads the game saved by saveGame. The snapshot is restored into a copy of the game first, so a broken file leaves the game as it was.
 ///
-/// @param [out] gamestate a gamestate instance
-/// @param [out] gameObjects a gameObjects vector, cleared/loaded if the game is restarted/started
-void increaseLevel(CGameState &gamestate, std::vector<std::unique_ptr<CGameObject>> &gameObjects)
+/// @param [in, out] game a game instance
+/// @param [out] rewind the rewind buffer, cleared when a game is loaded
+void loadGame(CGame &game, CRewindBuffer &rewind)
 {
-    gamestate.level++;
-
-    if (gamestate.guardTime > 1)
-        gamestate.guardTime -= gamestate.GUARD_TIME_DECREMENT;
+    CGameSnapshot snapshot;
+    CGame loaded = game;
 
-    if (gamestate.powerUpTime > 1)
-        gamestate.powerUpTime -= gamestate.POWER_UP_TIME_DECREMENT;
+    if (!snapshot.readFile("build/savegame.bin", CDistanceTable::hashMap(game.gamestate.gameMap)) || !loaded.restoreState(snapshot))
+    {
+        std::cout << "Error loading the game, it is missing or was saved on a different map." << std::endl;
+        return;
+    }
 
-    gameObjects.clear();
-    setup(gamestate, gameObjects);
+    game = loaded;
+    rewind.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Called every frame to check if the ghosts should enter or exit power up mode
+/// Handles the key presses the window posted to the simulation thread, in the order they were pressed. Runs on the simulation thread.
 ///
-/// @param [out] gamestate a gamestate instance
-/// @param [in] deltaTime time change since last frame, used for time keeping
-void updatePowerUp(CGameState &gamestate, double deltaTime)
+/// @param [out] game a game instance, restarted if the player wants to play again
+/// @param [out] input the queue of moves, every move keeps the time its key was pressed
+/// @param [out] rewind the rewind buffer, cleared when a game is loaded (F9) or restarted
+/// @param [out] rewinding true while backspace is held, its release is posted too
+/// @param [in] keys the key events
+void processKeys(CGame &game, CInputQueue &input, CRewindBuffer &rewind, bool &rewinding, const std::vector<SDL_Event> &keys)
 {
-    if (gamestate.powerUpRemaining > 0)
-    {
-        gamestate.powerUpRemaining -= deltaTime;
+    // event timestamps are milliseconds since SDL was initialized, this converts them to the clock the game loop runs on
+    CInputQueue::CTime now = std::chrono::steady_clock::now();
+    CInputQueue::CTime ticksOrigin = now - std::chrono::milliseconds(SDL_GetTicks());
 
-        if (gamestate.powerUpRemaining <= 0)
-            gamestate.gamemode = CGameState::CGameMode::chase;
+    for (const SDL_Event &event : keys)
+    {
+        if (event.key.keysym.sym == SDLK_BACKSPACE)
+            rewinding = event.type == SDL_KEYDOWN;
+
+        if (event.type != SDL_KEYDOWN)
+            continue;
+
+        if (event.key.keysym.sym == SDLK_F5)
+            saveGame(game);
+        else if (event.key.keysym.sym == SDLK_F9)
+            loadGame(game, rewind);
+        else
+            handleKeyDown(game, input, rewind, event, std::min(now, ticksOrigin + std::chrono::milliseconds(event.key.timestamp)));
     }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Called every frame to check if the ghosts should enter or exit guard mode
+/// A wrapper function that checks for quit events or key down events. All of the pending events are processed, so that keys pressed in quick succession
+/// do not wait for the following frames. The keys that control the game are posted to the simulation thread, the ones that only concern the window are handled here.
 ///
-/// @param [out] gamestate a gamestate instance
-/// @param [in] deltaTime time change since last frame, used for time keeping
-void updateGuard(CGameState &gamestate, double deltaTime)
+/// @param [out] keys the mailbox of the simulation thread, the key presses and the release of backspace are posted to it
+/// @param [out] boardLayer the pre-rendered board, invalidated if SDL loses the contents of target textures
+/// @param [out] showProfiler toggled by F3
+/// @param [out] playing a boolean that keeps the game loop running, cleared by esc or by closing the window
+/// @return true if an event that can change what is drawn was processed
+bool processInput(CMailbox<SDL_Event> &keys, CBoardLayer &boardLayer, bool &showProfiler, bool &playing)
 {
-    if (gamestate.guardTimeRemaining > 0)
+    bool changed = false;
+
+    SDL_Event event;
+    while (SDL_PollEvent(&event))
     {
-        gamestate.guardTimeRemaining -= deltaTime;
+        switch (event.type)
+        {
+        case (SDL_QUIT):
+            playing = false;
+            changed = true;
+            break;
 
-        if (gamestate.guardTimeRemaining <= 0)
-            gamestate.gamemode = CGameState::CGameMode::chase;
-    }
+        case (SDL_WINDOWEVENT):
+        case (SDL_USEREVENT): // the simulation thread published a state while the loop may be waiting for events
+            changed = true;
+            break;
 
-    if (gamestate.nextGuard < 0 && gamestate.gamemode != CGameState::CGameMode::powerup) // ghosts will not enter guard mode while a power up is active
-    {
-        gamestate.gamemode = CGameState::CGameMode::guard;
-        gamestate.guardTimeRemaining = gamestate.guardTime;
-        gamestate.nextGuard = gamestate.TIME_BETWEEN_GUARD_MODE;
+        case (SDL_KEYDOWN):
+            if (event.key.keysym.sym == SDLK_F3)
+                showProfiler = !showProfiler;
+            else if (event.key.keysym.sym == SDLK_ESCAPE) // break the game cycle
+                playing = false;
+            else
+                keys.post(event);
+            changed = true;
+            break;
+
+        case (SDL_KEYUP):
+            if (event.key.keysym.sym == SDLK_BACKSPACE)
+                keys.post(event);
+            break;
+
+        case (SDL_RENDER_TARGETS_RESET):
+        case (SDL_RENDER_DEVICE_RESET):
+            boardLayer.invalidate();
+            changed = true;
+            break;
+        }
     }
-}
 
-////////////////////////////////////////////////////////////////////////////////
-/// A wrapper function that calls the individual functions taking care of gamemodes (updateGuard and updatePowerUp)
-///
-/// @param [out] gamestate a gamestate instance
-/// @param [in] deltaTime time change since last frame, used for time keeping
-void updateGameModes(CGameState &gamestate, double deltaTime)
-{
-    updatePowerUp(gamestate, deltaTime);
-    updateGuard(gamestate, deltaTime);
+    return changed;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// A wrapper function that polymorphically calls update on every game object.
+/// Runs on every pass of the simulation thread. Takes as many fixed steps as fit into the real time that passed since the previous pass.
 ///
-/// @param [out] gamestate a gamestate instance
-/// @param [in] deltaTime time change since last frame, used for time keeping
-/// @param [out] gameObjects a gameObjects vector
-void updateGameObjects(CGameState &gamestate, std::vector<std::unique_ptr<CGameObject>> &gameObjects, double deltaTime)
-{
-    for (auto const &gameObject : gameObjects)
-        gameObject->update(gamestate, deltaTime);
-}
-
-////////////////////////////////////////////////////////////////////////////////
-/// A wrapper function that updates the player position and calls other update functions. Called if the active window is playing.
+/// @note The time that does not fill a whole step is carried over to the next pass.
+/// The steps cover the real time up to now minus the carried over time. Queued moves are applied before the first step that starts after their key press.
+/// While backspace is held, no step is taken, every pass goes one snapshot of the rewind buffer back instead.
 ///
-/// @param [out] gamestate a gamestate instance
-/// @param [in] deltaTime time change since last frame, used for time keeping
-/// @param [out] gameObjects a gameObjects vector
-void updatePlaying(CGameState &gamestate, std::vector<std::unique_ptr<CGameObject>> &gameObjects, double deltaTime)
+/// When a replay is played, its moves are applied before every step instead of the queued ones, and the game is over when it ends.
+///
+/// @param[in] game a game instance
+/// @param[in, out] input the queue of moves
+/// @param[in, out] rewind the rewind buffer, a snapshot is recorded after the steps
+/// @param[in, out] playback the replay being played, null if the player is playing
+/// @param[in] rewinding true while backspace is held
+/// @param[in, out] lastUpdateTime time of the previous pass, measured by a high resolution clock
+/// @param[in, out] accumulator seconds of real time that were not simulated yet
+/// @return how far the game is between the previous and the current step, from 0 to 1
+double update(CGame &game, CInputQueue &input, CRewindBuffer &rewind, CReplay *playback, bool rewinding, std::chrono::steady_clock::time_point &lastUpdateTime, double &accumulator)
 {
-    gamestate.nextGuard -= deltaTime;
-
-    if (gamestate.isThisMoveLegal())
-        gamestate.updatePos(deltaTime);
+    const double maxFrameTime = 0.25; // if a pass comes later than this (e.g. the window was dragged), the game slows down instead of trying to catch up
 
-    if (gamestate.isNextMoveLegal())
-        gamestate.updateMoves();
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    accumulator += std::min(std::chrono::duration<double>(now - lastUpdateTime).count(), maxFrameTime);
+    lastUpdateTime = now;
 
-    updateGameModes(gamestate, deltaTime);
-    updateGameObjects(gamestate, gameObjects, deltaTime);
-}
+    if (!playback && rewinding) // checked before the screen, so that a game can be rewound after the player was caught
+    {
+        rewind.rewind(game);
+        input.clear();
+        accumulator = 0;
+        return 1;
+    }
 
-////////////////////////////////////////////////////////////////////////////////
-/// Runs once every frame. Calls increaseLevel if necessary and updatePlaying if the active screen is "playing".
-///
-/// @note Also handles delta time updates.
-///
-/// @param[in] gamestate a gamestate variable
-/// @param[in] gameObjects a vector of unique pointers to game objects. Polymorphism applied here.
-/// @param[in] lastFrameTime Time ellapsed from previous frame. Used for proper delta-time calculations
-void update(CGameState &gamestate, std::vector<std::unique_ptr<CGameObject>> &gameObjects, int &lastFrameTime)
-{
-    if (gamestate.gameMap.coinCount == 0)
+    if (game.gamestate.screen != CGameState::CScreen::playing) // nothing moves on the other screens, and the time spent on them is not made up for later
     {
-        increaseLevel(gamestate, gameObjects);
+        input.clear();
+        accumulator = 0;
+        return 1;
     }
 
-    double deltaTime = (SDL_GetTicks() - lastFrameTime) / 1000.0f;
-    lastFrameTime = SDL_GetTicks();
+    std::chrono::duration<double> tick(CGame::TICK);
+    CInputQueue::CTime stepStart = now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(accumulator));
 
-    if (gamestate.screen == CGameState::CScreen::playing)
+    while (accumulator >= CGame::TICK)
     {
-        updatePlaying(gamestate, gameObjects, deltaTime);
+        if (!playback)
+            input.apply(game.gamestate, stepStart);
+        else if (!playback->apply(game.gamestate))
+        {
+            game.gamestate.screen = CGameState::CScreen::gameOver;
+            break;
+        }
+
+        game.step();
+        rewind.record(game);
+        accumulator -= CGame::TICK;
+        stepStart += std::chrono::duration_cast<std::chrono::steady_clock::duration>(tick);
     }
+
+    if (playback)
+        input.clear();
+
+    return accumulator / CGame::TICK;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Draws a simple wall object.
+/// Finishes the recording of the game and writes it to build/replay.bin.
 ///
-/// @param [in] x x coordinate
-/// @param [in] y y cooridnate
-/// @param [in] renderer pointer to the SDL_Renderer
-/// @param [in] gamestate a gamestate variable. Used to read the window dimensions.
-void drawWall(int x, int y, SDL_Renderer *renderer, const CGameState &gamestate)
+/// @param [in] game a game instance
+/// @param [in, out] replay the recording
+void saveReplay(const CGame &game, CReplay &replay)
 {
-    SDL_SetRenderDrawColor(renderer, 20, 20, 50, 255);
-
-    SDL_Rect wall =
-        {static_cast<int>(gamestate.WINDOW_WIDTH / static_cast<double>(gamestate.gameMap.BOARDWIDTH) * x),
-         static_cast<int>(gamestate.WINDOW_HEIGHT / static_cast<double>(gamestate.gameMap.BOARDHEIGHT) * y),
-         static_cast<int>(gamestate.WINDOW_WIDTH / static_cast<double>(gamestate.gameMap.BOARDWIDTH)),
-         static_cast<int>(gamestate.WINDOW_HEIGHT / static_cast<double>(gamestate.gameMap.BOARDHEIGHT))};
-    SDL_RenderFillRect(renderer, &wall);
+    replay.finish(game.gamestate);
+
+    if (!replay.write("build/replay.bin"))
+        std::cout << "Error writing the replay." << std::endl;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Draws the playing board.
-///
-/// @param [in] gamestate a gamestate variable
-/// @param [in] renderer  pointer to the SDL_Renderer
-void drawMap(const CGameState &gamestate, SDL_Renderer *renderer)
-{
-    for (int i = 0; i < gamestate.gameMap.BOARDHEIGHT; i++)
-        for (int j = 0; j < gamestate.gameMap.BOARDWIDTH; j++)
-            if (gamestate.gameMap.map[i][j] == gamestate.gameMap.CMapObjects::W)
-                drawWall(j, i, renderer, gamestate);
-};
+/// The loop of the simulation thread. Every pass handles the posted key presses, takes the steps that are due and publishes the state of the game to the render thread.
+/// Then it sleeps until the next step is due, or until a key is pressed if nothing moves.
+///
+/// @note The thread owns the game while it runs. Its phases are measured by a profiler of its own, their times are published with the state.
+///
+/// @param [in, out] game a game instance
+/// @param [in, out] replay the recording, written when a game is over
+/// @param [in, out] playback the replay being played, null if the player is playing
+/// @param [in, out] keys the key events posted by the window, the thread returns when the mailbox is closed
+/// @param [out] states the published states
+/// @param [out] allocatingPasses passes of a running game that allocated, counted if the allocations are tracked
+void simulate(CGame &game, CReplay &replay, CReplay *playback, CMailbox<SDL_Event> &keys, CTripleBuffer<CRenderState> &states, int &allocatingPasses)
+{
+    const std::chrono::duration<double> rewindPeriod(1 / 60.0); // while rewinding, a snapshot is restored this often, about 4 times as fast as they are taken
+    const std::chrono::duration<double> tick(CGame::TICK);
+
+    CProfiler profiler;
+    game.profiler = &profiler;
+    CInputQueue input;
+    CRewindBuffer rewind;
+    rewind.reserve(game);
+    std::vector<SDL_Event> pressed;
+    pressed.reserve(CInputQueue::CAPACITY);
+    bool rewinding = false;
+    double phaseTimes[CProfiler::PHASE_COUNT] = {};
+    unsigned long long moveCount = 0;
+    CInputQueue::CTime lastMoveTime{};
+    CGameState::CScreen publishedScreen = game.gamestate.screen;
+    std::chrono::steady_clock::time_point lastUpdateTime = std::chrono::steady_clock::now();
+    double accumulator = 0;
+    int steadyPasses = 0; // passes since the screen was changed to playing
+    bool running = true;
+
+    while (running)
+    {
+        profiler.beginFrame();
+        CAllocationTracker::beginFrame();
 
-////////////////////////////////////////////////////////////////////////////////
-/// Draws the player.
-///
-/// @param[in] gamestate a gamestate variable
-/// @param [in] renderer  pointer to the SDL_Renderer
-void drawPlayer(CGameState &gamestate, SDL_Renderer *renderer)
-{
-    SDL_SetRenderDrawColor(renderer, 180, 180, 0, 255);
+        processKeys(game, input, rewind, rewinding, pressed);
+        pressed.clear();
+
+        double alpha = update(game, input, rewind, playback, rewinding, lastUpdateTime, accumulator);
+
+        if (replay.isRecording() && game.gamestate.screen == CGameState::CScreen::gameOver)
+            saveReplay(game, replay);
 
-    SDL_Rect player =
+        CInputQueue::CTime pressTime;
+        if (input.takeAppliedTime(pressTime))
         {
-            static_cast<int>(gamestate.WINDOW_WIDTH / static_cast<double>(gamestate.gameMap.BOARDWIDTH) * gamestate.playerPos.x),
-            static_cast<int>(gamestate.WINDOW_HEIGHT / static_cast<double>(gamestate.gameMap.BOARDHEIGHT) * gamestate.playerPos.y),
-            static_cast<int>(gamestate.WINDOW_WIDTH / (static_cast<double>(gamestate.gameMap.BOARDWIDTH))),
-            static_cast<int>(gamestate.WINDOW_HEIGHT / (static_cast<double>(gamestate.gameMap.BOARDHEIGHT)))};
-    SDL_RenderFillRect(renderer, &player);
-}
+            moveCount++;
+            lastMoveTime = pressTime;
+        }
 
-////////////////////////////////////////////////////////////////////////////////
-/// Draws the game objects. Polymorphism applied here.
-///
-/// @param[in] gamestate a gamestate variable
-/// @param [in] renderer  pointer to the SDL_Renderer
-/// @param[in] gameObjects a vector of unique pointers to game objects. Polymorphism applied here.
-void drawGameObjects(CGameState &gamestate, std::vector<std::unique_ptr<CGameObject>> &gameObjects, SDL_Renderer *renderer)
-{
-    for (auto const &gameObject : gameObjects)
-        gameObject->draw(renderer, gamestate);
+        profiler.endFrame();
+        for (int phase = 0; phase < CProfiler::PHASE_COUNT; phase++)
+            phaseTimes[phase] += profiler.getPhaseTime(profiler.getFrameCount() - 1, static_cast<CProfiler::CPhase>(phase));
+
+        CGameState::CScreen screen = game.gamestate.screen;
+        CRenderState &state = states.getWriteBuffer();
+        state.capture(game);
+        state.time = lastUpdateTime;
+        state.alpha = alpha;
+        state.moveCount = moveCount;
+        state.lastMoveTime = lastMoveTime;
+        std::copy(std::begin(phaseTimes), std::end(phaseTimes), state.phaseTimes);
+        states.publish(); // the slot may be read from now on, it is not touched again
+
+        // while nothing moves, the render thread sleeps until an event arrives, so it is woken up to draw the new state
+        if (screen != CGameState::CScreen::playing || publishedScreen != CGameState::CScreen::playing)
+        {
+            SDL_Event wakeup = {};
+            wakeup.type = SDL_USEREVENT;
+            SDL_PushEvent(&wakeup);
+        }
+        publishedScreen = screen;
+
+        size_t allocations = CAllocationTracker::endFrame();
+        if (screen != CGameState::CScreen::playing)
+            steadyPasses = 0;
+        else if (++steadyPasses > ALLOCATION_WARMUP_FRAMES && allocations > 0)
+        {
+            std::cout << "pass " << steadyPasses << " of the simulation allocated " << allocations << " times:" << std::endl;
+            CAllocationTracker::report();
+            allocatingPasses++;
+        }
+
+        if (rewinding && !playback)
+            running = keys.waitUntil(pressed, lastUpdateTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(rewindPeriod));
+        else if (screen == CGameState::CScreen::playing)
+            running = keys.waitUntil(pressed, lastUpdateTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(tick * (1 - alpha)));
+        else
+            running = keys.wait(pressed);
+    }
+
+    game.gamestate.saveScore(); // the game was closed on the game over screen
+    game.profiler = nullptr;    // the profiler ends with the thread
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Draws a text on the given coordinates.
+/// Draws the player, interpolated between his previous and current position.
 ///
-/// @note The text is centered around these coordinates.
-///
-/// @param[in] renderer pointer to the SDL_Renderer
-/// @param [in] font  pointer to a TTF_Font
-/// @param[in] text a string holding the text
-/// @param[in] x The x coordinate
-/// @param[in] y The y coordinate
-void drawText(SDL_Renderer *renderer, TTF_Font *font, std::string &text, int x, int y)
+/// @param[in] state the published state of the game
+/// @param [in] canvas the canvas to draw on
+/// @param [in] alpha how far the renderer is between the previous and the current step, from 0 to 1
+void drawPlayer(const CRenderState &state, CCanvas &canvas, double alpha)
 {
-    SDL_Color textColor = {255, 255, 255};
-    int textWidth = 0;
-    int textHeight = 0;
-
-    SDL_Texture *fontTexture = nullptr;
-    SDL_Surface *textSurface = TTF_RenderText_Solid(font, text.c_str(), textColor);
-    // Drawing a texture instead of a surface is arguably faster, as a texture is stored in the VRAM.
-    fontTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-
-    if (textSurface != nullptr)
-    {
-        textWidth = textSurface->w;
-        textHeight = textSurface->h;
-
-        SDL_Rect dst = {
-            x - textWidth / 2,
-            y - textHeight / 2,
-            textWidth,
-            textHeight};
-        SDL_RenderCopy(renderer, fontTexture, NULL, &dst);
-    }
-
-    SDL_FreeSurface(textSurface); // cleanup
-    SDL_DestroyTexture(fontTexture);
+    CPos playerPos = CPos::interpolate(state.previousPlayerPos, state.playerPos, alpha);
+    canvas.fillTile(playerPos, 1, 180, 180, 0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -543,8 +589,8 @@ void drawText(SDL_Renderer *renderer, TTF_Font *font, std::string &text, int x,
 ///
 /// @param[in] gamestate a gamestate instance. Used to get the window dimensions.
 /// @param [in] renderer  pointer to the SDL_Renderer
-/// @param[in] font pointer to a TTF_Font
-void drawStartOverlay(const CGameState &gamestate, SDL_Renderer *renderer, TTF_Font *font)
+/// @param[in] textCache the text cache the text is drawn with
+void drawStartOverlay(const CGameState &gamestate, SDL_Renderer *renderer, CTextCache &textCache)
 {
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 120);
 
@@ -556,17 +602,17 @@ void drawStartOverlay(const CGameState &gamestate, SDL_Renderer *renderer, TTF_F
 
     SDL_RenderFillRect(renderer, &background);
 
-    std::string text = "PRESS ANY KEY TO START.";
-    drawText(renderer, font, text, gamestate.WINDOW_WIDTH / 2, gamestate.WINDOW_HEIGHT / 2);
+    textCache.drawStatic("PRESS ANY KEY TO START.", gamestate.WINDOW_WIDTH / 2, gamestate.WINDOW_HEIGHT / 2);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Draws the overlay for when the game is over.
 ///
 /// @param[in] gamestate a gamestate instance. Used to get the window dimensions.
+/// @param[in] state the published state of the game. Used to get the score.
 /// @param [in] renderer  pointer to the SDL_Renderer
-/// @param [in] font  pointer to a TTF_Font
-void drawGameOverOverlay(CGameState &gamestate, SDL_Renderer *renderer, TTF_Font *font)
+/// @param [in] textCache the text cache the text is drawn with
+void drawGameOverOverlay(const CGameState &gamestate, const CRenderState &state, SDL_Renderer *renderer, CTextCache &textCache)
 {
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 120);
 
@@ -578,73 +624,60 @@ void drawGameOverOverlay(CGameState &gamestate, SDL_Renderer *renderer, TTF_Font
 
     SDL_RenderFillRect(renderer, &background);
 
-    std::string text1 = "GAME OVER.";
-    std::string text2 = "SCORE " + std::to_string(gamestate.score);
-
-    std::string text3 = "ESC                                     QUIT";
-    std::string text4 = "SPACE          PLAY AGAIN";
-    std::string text5 = "H      VIEW HIGH SCORES";
-
-    drawText(renderer,
-             font,
-             text1,
-             gamestate.WINDOW_WIDTH / 2,
-             // multiplying the dimensions like this allows us to present responsivness when the dimensions change.
-             gamestate.WINDOW_HEIGHT / 2 - gamestate.WINDOW_HEIGHT * 0.3);
-    drawText(renderer,
-             font,
-             text2,
-             gamestate.WINDOW_WIDTH / 2,
-             gamestate.WINDOW_HEIGHT / 2 - gamestate.WINDOW_HEIGHT * 0.2);
-
-    drawText(renderer,
-             font, text3,
-             gamestate.WINDOW_WIDTH / 2,
-             gamestate.WINDOW_HEIGHT / 2);
-    drawText(renderer,
-             font,
-             text4,
-             gamestate.WINDOW_WIDTH / 2,
-             gamestate.WINDOW_HEIGHT / 2 + gamestate.WINDOW_HEIGHT * 0.1);
-    drawText(renderer,
-             font,
-             text5,
-             gamestate.WINDOW_WIDTH / 2,
-             gamestate.WINDOW_HEIGHT / 2 + gamestate.WINDOW_HEIGHT * 0.2);
+    char scoreText[32];
+    snprintf(scoreText, sizeof(scoreText), "SCORE %d", state.score);
+
+    textCache.drawStatic("GAME OVER.",
+                         gamestate.WINDOW_WIDTH / 2,
+                         // multiplying the dimensions like this allows us to present responsivness when the dimensions change.
+                         gamestate.WINDOW_HEIGHT / 2 - gamestate.WINDOW_HEIGHT * 0.3);
+    textCache.drawComposed(scoreText,
+                           gamestate.WINDOW_WIDTH / 2,
+                           gamestate.WINDOW_HEIGHT / 2 - gamestate.WINDOW_HEIGHT * 0.2);
+
+    textCache.drawStatic("ESC                                     QUIT",
+                         gamestate.WINDOW_WIDTH / 2,
+                         gamestate.WINDOW_HEIGHT / 2);
+    textCache.drawStatic("SPACE          PLAY AGAIN",
+                         gamestate.WINDOW_WIDTH / 2,
+                         gamestate.WINDOW_HEIGHT / 2 + gamestate.WINDOW_HEIGHT * 0.1);
+    textCache.drawStatic("H      VIEW HIGH SCORES",
+                         gamestate.WINDOW_WIDTH / 2,
+                         gamestate.WINDOW_HEIGHT / 2 + gamestate.WINDOW_HEIGHT * 0.2);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Draws the scores from highest to lowest.
 ///
-/// @param[in] gamestate a gamestate instance. Used to get the window dimensions and the scores.
-/// @param [in] renderer  pointer to the SDL_Renderer
-/// @param [in] font  pointer to a TTF_Font
-void drawScores(CGameState &gamestate, SDL_Renderer *renderer, TTF_Font *font)
+/// @param[in] gamestate a gamestate instance. Used to get the window dimensions.
+/// @param[in] state the published state of the game. Used to get the scores.
+/// @param [in] textCache the text cache the text is drawn with
+void drawScores(const CGameState &gamestate, const CRenderState &state, CTextCache &textCache)
 {
     int position = 1;
-    for (auto score : gamestate.highscores)
+    for (auto score : state.topScores)
     {
         if (position > 3) // we only want to view the top 3 scores.
             break;
 
-        std::string scoreText = std::to_string(position) + ". SCORE " + std::to_string(score.first) + "    LEVEL " + std::to_string(score.second);
+        char scoreText[64];
+        snprintf(scoreText, sizeof(scoreText), "%d. SCORE %d    LEVEL %d", position, score.first, score.second);
         position++;
-        drawText(renderer,
-                 font,
-                 scoreText,
-                 gamestate.WINDOW_WIDTH / 2,
-                 // again, this works responsively
-                 gamestate.WINDOW_HEIGHT / 2 - gamestate.WINDOW_HEIGHT * 0.3 + gamestate.WINDOW_HEIGHT * (position * 0.1));
+        textCache.drawComposed(scoreText,
+                               gamestate.WINDOW_WIDTH / 2,
+                               // again, this works responsively
+                               gamestate.WINDOW_HEIGHT / 2 - gamestate.WINDOW_HEIGHT * 0.3 + gamestate.WINDOW_HEIGHT * (position * 0.1));
     }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Draws the overlay that shows when the score board is open.
 ///
-/// @param[in] gamestate a gamestate instance. Used to get the window dimensions and the scores.
+/// @param[in] gamestate a gamestate instance. Used to get the window dimensions.
+/// @param[in] state the published state of the game. Used to get the scores.
 /// @param [in] renderer  pointer to the SDL_Renderer
-/// @param [in] font  pointer to a TTF_Font
-void drawScoreBoardOverlay(CGameState &gamestate, SDL_Renderer *renderer, TTF_Font *font)
+/// @param [in] textCache the text cache the text is drawn with
+void drawScoreBoardOverlay(const CGameState &gamestate, const CRenderState &state, SDL_Renderer *renderer, CTextCache &textCache)
 {
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 120);
 
@@ -656,111 +689,331 @@ void drawScoreBoardOverlay(CGameState &gamestate, SDL_Renderer *renderer, TTF_Fo
 
     SDL_RenderFillRect(renderer, &background);
 
-    drawScores(gamestate, renderer, font);
-
-    std::string text = "HIGH SCORES";
-    std::string text2 = "ESC                                     QUIT";
-    std::string text3 = "H                                          BACK";
-
-    drawText(renderer,
-             font,
-             text,
-             gamestate.WINDOW_WIDTH / 2,
-             // responsive
-             gamestate.WINDOW_HEIGHT / 2 - gamestate.WINDOW_HEIGHT * 0.3);
-    drawText(renderer,
-             font,
-             text2,
-             gamestate.WINDOW_WIDTH / 2,
-             gamestate.WINDOW_HEIGHT / 2 + gamestate.WINDOW_HEIGHT * 0.3);
-    drawText(renderer,
-             font,
-             text3,
-             gamestate.WINDOW_WIDTH / 2,
-             gamestate.WINDOW_HEIGHT / 2 + gamestate.WINDOW_HEIGHT * 0.4);
+    drawScores(gamestate, state, textCache);
+
+    textCache.drawStatic("HIGH SCORES",
+                         gamestate.WINDOW_WIDTH / 2,
+                         // responsive
+                         gamestate.WINDOW_HEIGHT / 2 - gamestate.WINDOW_HEIGHT * 0.3);
+    textCache.drawStatic("ESC                                     QUIT",
+                         gamestate.WINDOW_WIDTH / 2,
+                         gamestate.WINDOW_HEIGHT / 2 + gamestate.WINDOW_HEIGHT * 0.3);
+    textCache.drawStatic("H                                          BACK",
+                         gamestate.WINDOW_WIDTH / 2,
+                         gamestate.WINDOW_HEIGHT / 2 + gamestate.WINDOW_HEIGHT * 0.4);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Handles drawing of all UI overlays.
 ///
-/// @param[in] gamestate a gamestate instance. Used to get the window dimensions and the scores.
+/// @param[in] gamestate a gamestate instance. Used to get the window dimensions.
+/// @param[in] state the published state of the game. Used to get the screen and the scores.
 /// @param [in] renderer  pointer to the SDL_Renderer
-/// @param [in] font  pointer to a TTF_Font
-void drawGUI(CGameState &gamestate, SDL_Renderer *renderer, TTF_Font *font)
-{
-    std::string scoreText = "SCORE " + std::to_string(gamestate.score);
-    std::string levelText = "LEVEL " + std::to_string(gamestate.level);
-    drawText(renderer,
-             font,
-             scoreText,
-             gamestate.WINDOW_WIDTH * 0.33,
-             gamestate.WINDOW_HEIGHT + gamestate.BOTTOM_PADDING / 2);
-    drawText(renderer,
-             font,
-             levelText,
-             gamestate.WINDOW_WIDTH * 0.66,
-             gamestate.WINDOW_HEIGHT + gamestate.BOTTOM_PADDING / 2);
+/// @param [in] textCache the text cache the text is drawn with
+void drawGUI(const CGameState &gamestate, const CRenderState &state, SDL_Renderer *renderer, CTextCache &textCache)
+{
+    char scoreText[32];
+    char levelText[32];
+    snprintf(scoreText, sizeof(scoreText), "SCORE %d", state.score);
+    snprintf(levelText, sizeof(levelText), "LEVEL %d", state.level);
+    textCache.drawComposed(scoreText,
+                           gamestate.WINDOW_WIDTH * 0.33,
+                           gamestate.WINDOW_HEIGHT + gamestate.BOTTOM_PADDING / 2);
+    textCache.drawComposed(levelText,
+                           gamestate.WINDOW_WIDTH * 0.66,
+                           gamestate.WINDOW_HEIGHT + gamestate.BOTTOM_PADDING / 2);
+
+    if (state.screen == CGameState::CScreen::start)
+        drawStartOverlay(gamestate, renderer, textCache);
+
+    else if (state.screen == CGameState::CScreen::gameOver)
+        drawGameOverOverlay(gamestate, state, renderer, textCache);
+
+    else if (state.screen == CGameState::CScreen::scoreBoard)
+        drawScoreBoardOverlay(gamestate, state, renderer, textCache);
+}
 
-    if (gamestate.screen == CGameState::CScreen::start)
-        drawStartOverlay(gamestate, renderer, font);
+////////////////////////////////////////////////////////////////////////////////
+/// Draws the profiler overlay: frame time percentiles, a sparkline of the recent frames, the average time of every phase over them, the input latency
+/// and the average CPU time per frame.
+///
+/// @param [in] profiler the profiler
+/// @param [in] batch the sprite batch the sparkline is drawn with
+/// @param [in] renderer  pointer to the SDL_Renderer
+/// @param [in] textCache the text cache the text is drawn with
+void drawProfiler(CProfiler &profiler, CSpriteBatch &batch, SDL_Renderer *renderer, CTextCache &textCache)
+{
+    const int recentFrames = 120;           // frames in the sparkline and in the phase averages
+    const double sparklineScale = 1 / 30.0; // seconds at the full height of the sparkline, two 60 Hz frames
+    const double frameBudget = 1 / 60.0;    // longer frames are drawn red
+    const int lineHeight = 22;
+    const int sparklineHeight = 60;
+    const int width = 2 * recentFrames + 80;
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 200);
+    SDL_Rect background = {0, 0, width, lineHeight * (CProfiler::PHASE_COUNT + 3) + sparklineHeight + 20};
+    SDL_RenderFillRect(renderer, &background);
 
-    else if (gamestate.screen == CGameState::CScreen::gameOver)
-        drawGameOverOverlay(gamestate, renderer, font);
+    char text[96];
+    snprintf(text, sizeof(text), "P50 %.2f  P99 %.2f  MAX %.2f MS",
+             profiler.getPercentile(0.5) * 1000, profiler.getPercentile(0.99) * 1000, profiler.getPercentile(1) * 1000);
+    textCache.drawComposed(text, width / 2, lineHeight / 2 + 5);
 
-    else if (gamestate.screen == CGameState::CScreen::scoreBoard)
-        drawScoreBoardOverlay(gamestate, renderer, font);
+    size_t frameCount = profiler.getFrameCount();
+    size_t first = frameCount > recentFrames ? frameCount - recentFrames : 0;
+    int sparklineBottom = lineHeight + 10 + sparklineHeight;
+
+    for (size_t frame = first; frame < frameCount; frame++)
+    {
+        double frameTime = profiler.getFrameTime(frame);
+        int height = std::min(sparklineHeight, static_cast<int>(frameTime / sparklineScale * sparklineHeight) + 1);
+        SDL_Rect bar = {40 + 2 * static_cast<int>(frame - first), sparklineBottom - height, 2, height};
+
+        if (frameTime > frameBudget)
+            batch.add(bar, 200, 40, 40);
+        else
+            batch.add(bar, 40, 200, 40);
+    }
+    batch.flush();
+
+    for (int phase = 0; phase < CProfiler::PHASE_COUNT; phase++)
+    {
+        double total = 0;
+        for (size_t frame = first; frame < frameCount; frame++)
+            total += profiler.getPhaseTime(frame, static_cast<CProfiler::CPhase>(phase));
+
+        snprintf(text, sizeof(text), "%s %.3f MS", CProfiler::getPhaseName(static_cast<CProfiler::CPhase>(phase)),
+                 frameCount > first ? total / (frameCount - first) * 1000 : 0.0);
+        textCache.drawComposed(text, width / 2, sparklineBottom + 10 + lineHeight * phase + lineHeight / 2);
+    }
+
+    double lastLatency = 0;
+    double maxLatency = 0;
+    for (size_t frame = first; frame < frameCount; frame++)
+        if (profiler.getInputLatency(frame) > 0)
+        {
+            lastLatency = profiler.getInputLatency(frame);
+            maxLatency = std::max(maxLatency, lastLatency);
+        }
+
+    snprintf(text, sizeof(text), "INPUT LATENCY %.2f  MAX %.2f MS", lastLatency * 1000, maxLatency * 1000);
+    textCache.drawComposed(text, width / 2, sparklineBottom + 10 + lineHeight * CProfiler::PHASE_COUNT + lineHeight / 2);
+
+    double cpuTime = 0;
+    for (size_t frame = first; frame < frameCount; frame++)
+        cpuTime += profiler.getCpuTime(frame);
+
+    snprintf(text, sizeof(text), "CPU %.2f MS PER FRAME", frameCount > first ? cpuTime / (frameCount - first) * 1000 : 0.0);
+    textCache.drawComposed(text, width / 2, sparklineBottom + 10 + lineHeight * (CProfiler::PHASE_COUNT + 1) + lineHeight / 2);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Used to handle rendering. Runs once every frame.
+/// Used to handle rendering. Runs once every frame on the render thread.
 ///
-/// @param[in] gamestate a gamestate variable
-/// @param[in] gameObjects a vector of unique pointers to game objects. Polymorphism applied here.
-/// @param [in] font  pointer to a TTF_Font
+/// @param[in] gamestate the render thread's copy of the gamestate. Used to get the configuration and the map.
+/// @param[in] state the published state of the game
+/// @param [in, out] camera the camera, moved to follow the player
+/// @param [in] boardLayer the pre-rendered board
+/// @param [in] canvas the canvas the ghosts and the player are drawn on
+/// @param [in] batch the sprite batch behind the canvas, flushed once for all of the actors
+/// @param [in] textCache the text cache the text is drawn with
+/// @param [in] profiler the profiler the drawing phases are measured by
+/// @param [in] showProfiler true if the profiler overlay is shown
 /// @param [in] renderer  pointer to the SDL_Renderer
-void draw(CGameState &gamestate, std::vector<std::unique_ptr<CGameObject>> &gameObjects, SDL_Renderer *renderer, TTF_Font *font)
+/// @param [in] alpha how far the renderer is between the previous and the current step, from 0 to 1
+void draw(const CGameState &gamestate, const CRenderState &state, CCamera &camera, CBoardLayer &boardLayer, CSDLCanvas &canvas, CSpriteBatch &batch,
+          CTextCache &textCache, CProfiler &profiler, bool showProfiler, SDL_Renderer *renderer, double alpha)
 {
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
     SDL_RenderClear(renderer);
 
-    drawMap(gamestate, renderer);
-    drawGameObjects(gamestate, gameObjects, renderer);
-    drawPlayer(gamestate, renderer);
-    drawGUI(gamestate, renderer, font);
+    camera.follow(CPos::interpolate(state.previousPlayerPos, state.playerPos, alpha));
 
-    SDL_RenderPresent(renderer);
+    {
+        CProfiler::CScope scope(&profiler, CProfiler::drawMap);
+        boardLayer.draw(gamestate, state.collectibles);
+    }
+    {
+        CProfiler::CScope scope(&profiler, CProfiler::drawGameObjects);
+        state.ghosts.draw(canvas, state.gamemode, alpha);
+        drawPlayer(state, canvas, alpha);
+        batch.flush();
+    }
+    {
+        CProfiler::CScope scope(&profiler, CProfiler::drawGUI);
+        drawGUI(gamestate, state, renderer, textCache);
+
+        if (showProfiler)
+            drawProfiler(profiler, batch, renderer, textCache);
+    }
+    {
+        CProfiler::CScope scope(&profiler, CProfiler::present);
+        SDL_RenderPresent(renderer);
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Contains the game loop at the highest level as well as some initialization and cleanup.
+/// Contains the render loop at the highest level as well as some initialization and cleanup. The game itself runs on the simulation thread (simulate),
+/// the render loop draws the newest state it published, so neither waits for the other.
+///
+/// Usage: svobov25 [replay file] [vsync | cap [fps] | uncapped]
 ///
-int main()
+/// On the start, game over and score board screens, nothing moves. The loop then blocks until an event arrives and only draws a frame when one was processed.
+int main(int argc, char *argv[])
 {
+    int arg = 1;
+    std::string replayPath;
+    if (argc > 2 && std::string(argv[1]) == "replay")
+    {
+        replayPath = argv[2];
+        arg = 3;
+    }
+
+    CFramePacer::CMode pacingMode = CFramePacer::CMode::vsync;
+    if (argc > arg && !CFramePacer::parseMode(argv[arg], pacingMode))
+    {
+        std::cout << "Usage: svobov25 [replay file] [vsync | cap [fps] | uncapped]" << std::endl;
+        return 1;
+    }
+    CFramePacer pacer(pacingMode, argc > arg + 1 ? atof(argv[arg + 1]) : CFramePacer::DEFAULT_FPS);
 
     SDL_Window *window = nullptr;
     SDL_Renderer *renderer = nullptr;
     TTF_Font *font = nullptr;
 
-    CGameState gamestate;
-    gamestate.loadConfig();
-    std::vector<std::unique_ptr<CGameObject>> gameObjects;
-    initializeWindow(gamestate, renderer, window);
-    openFont(gamestate, font);
-    loadHighScores(gamestate);
-    setup(gamestate, gameObjects);
+    CGame game;
+    game.gamestate.loadConfig();
+
+    CReplay replay;
+    CReplay *playback = nullptr;
+    if (!replayPath.empty())
+    {
+        try
+        {
+            replay.load(replayPath);
+            replay.configure(game.gamestate);
+        }
+        catch (const std::invalid_argument &error)
+        {
+            std::cout << "Error loading replay: " << error.what() << std::endl;
+            return 1;
+        }
+        playback = &replay;
+    }
+    initializeWindow(game.gamestate, renderer, window, pacingMode == CFramePacer::CMode::vsync);
+    openFont(game.gamestate, font);
+    loadHighScores(game.gamestate);
+    game.setup();
+
+    if (playback)
+        game.gamestate.screen = CGameState::CScreen::playing;
+    else
+    {
+        game.recorder = &replay;
+        replay.begin(game.gamestate);
+    }
 
+    // the render thread draws with its own copy of the configuration and the map, the simulation thread owns the game
+    const CGameState layout = game.gamestate;
+    CSpriteBatch batch(renderer);
+    CCamera camera(layout);
+    CSDLCanvas canvas(batch, camera, layout);
+    CBoardLayer boardLayer(renderer, canvas, batch, camera);
+    CTextCache textCache(renderer, font);
+    CProfiler profiler;
+    CMailbox<SDL_Event> keys(CInputQueue::CAPACITY);
+    CTripleBuffer<CRenderState> states;
+    bool showProfiler = false;
     bool playing = true;
-    int lastFrameTime = 0;
+    bool redraw = true;
+    double simulationTimes[CProfiler::PHASE_COUNT] = {}; // phase times of the simulation thread already added to the frames
+    unsigned long long drawnMoves = 0;                   // moves whose input latency was already measured
+    int steadyFrames = 0;                                // frames since the screen was changed to playing
+    int allocatingFrames = 0;                            // checked frames that allocated
+    int allocatingPasses = 0;                            // checked passes of the simulation thread that allocated
+
+    // the first state is published before the simulation thread starts, so that there always is one to draw
+    states.getWriteBuffer().capture(game);
+    states.publish();
+    std::thread simulation([&]()
+                           { simulate(game, replay, playback, keys, states, allocatingPasses); });
+
     while (playing)
     {
-        processInput(gamestate, gameObjects, playing);
-        update(gamestate, gameObjects, lastFrameTime);
-        draw(gamestate, gameObjects, renderer, font);
+        profiler.beginFrame();
+        CAllocationTracker::beginFrame();
+        {
+            CProfiler::CScope scope(&profiler, CProfiler::input);
+            if (processInput(keys, boardLayer, showProfiler, playing))
+                redraw = true;
+        }
+
+        if (states.update())
+            redraw = true;
+        const CRenderState &state = states.getReadBuffer();
+
+        // the simulation phases are measured by the simulation thread, a frame takes over the time it spent since the previous frame
+        for (int phase = 0; phase < CProfiler::PHASE_COUNT; phase++)
+        {
+            profiler.addTime(static_cast<CProfiler::CPhase>(phase), state.phaseTimes[phase] - simulationTimes[phase]);
+            simulationTimes[phase] = state.phaseTimes[phase];
+        }
+
+        if (!redraw && state.screen != CGameState::CScreen::playing)
+        {
+            SDL_WaitEvent(nullptr); // sleeps until there is an event, it stays in the queue for processInput
+            pacer.reset();
+            continue;
+        }
+
+        // the state was published at the end of a pass of the simulation thread, the steps due since then are not taken yet
+        double alpha = std::min(1.0, state.alpha + std::chrono::duration<double>(std::chrono::steady_clock::now() - state.time).count() / CGame::TICK);
+        draw(layout, state, camera, boardLayer, canvas, batch, textCache, profiler, showProfiler, renderer, alpha);
+
+        if (state.moveCount != drawnMoves)
+        {
+            profiler.addInputLatency(std::chrono::duration<double>(std::chrono::steady_clock::now() - state.lastMoveTime).count());
+            drawnMoves = state.moveCount;
+        }
+
+        redraw = state.screen == CGameState::CScreen::playing;
+        {
+            CProfiler::CScope scope(&profiler, CProfiler::pacing);
+            pacer.wait();
+        }
+        profiler.endFrame();
+
+        size_t allocations = CAllocationTracker::endFrame();
+        if (state.screen != CGameState::CScreen::playing)
+            steadyFrames = 0;
+        else if (++steadyFrames > ALLOCATION_WARMUP_FRAMES && allocations > 0)
+        {
+            std::cout << "frame " << steadyFrames << " of the game allocated " << allocations << " times:" << std::endl;
+            CAllocationTracker::report();
+            allocatingFrames++;
+        }
     }
 
-    saveHighScores(gamestate);
+    keys.close();
+    simulation.join();
+
+    if (replay.isRecording() && replay.getHeader().tickCount > 0) // a game left unfinished is recorded up to the exit
+        saveReplay(game, replay);
+
+    if (!profiler.writeCSV("build/frametimes.csv"))
+        std::cout << "Error writing frame times." << std::endl;
+
+    boardLayer.destroy();
+    textCache.destroy();
+    batch.destroy();
     closeFont(font);
     destroyWindow(renderer, window);
 
+    if (allocatingFrames > 0 || allocatingPasses > 0)
+    {
+        std::cout << allocatingFrames << " frames and " << allocatingPasses << " passes of the simulation of a running game allocated." << std::endl;
+        return 1;
+    }
+
     return 0;
 }
\ No newline at end of file
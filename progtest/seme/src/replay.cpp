@@ -0,0 +1,74 @@
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "CGame.h"
+#include "CSimulation.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// Plays recorded games again without a window, as fast as the CPU allows, and checks that every one ends with the recorded score and level.
+/// A corpus of replays is then both a regression test of the simulation and a benchmark of it.
+///
+/// Usage: svobov25-replay config replay [replay ...]
+///
+/// @return 0 if every replay ended as recorded, 1 otherwise
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: svobov25-replay config replay [replay ...]" << std::endl;
+        return 1;
+    }
+
+    CGameState loaded;
+    if (!loaded.loadConfig(argv[1]))
+        return 1; // the reason was already printed, a replay on the default map would not match
+    CSimulation::prepare(loaded);
+
+    int failed = 0;
+    double totalTime = 0;
+    double totalSeconds = 0;
+
+    for (int i = 2; i < argc; i++)
+    {
+        CReplay replay;
+        CGameState gamestate = loaded;
+
+        try
+        {
+            replay.load(argv[i]);
+            replay.configure(gamestate);
+        }
+        catch (const std::invalid_argument &error)
+        {
+            std::cout << argv[i] << " " << error.what() << std::endl;
+            failed++;
+            continue;
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        CGameResult result = CSimulation::replay(gamestate, replay);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const CReplayHeader &header = replay.getHeader();
+        bool matches = result.score == header.score && result.level == header.level &&
+                       result.time == header.tickCount * CGame::TICK;
+        if (!matches)
+            failed++;
+
+        totalTime += result.time;
+        totalSeconds += seconds;
+
+        std::cout << argv[i]
+                  << " score " << result.score
+                  << " level " << result.level
+                  << " time " << result.time
+                  << (matches ? " ok" : " MISMATCH")
+                  << " speed " << result.time / seconds << "x" << std::endl;
+    }
+
+    std::cout << argc - 2 - failed << "/" << argc - 2 << " replays ok, " << totalTime << " s of play simulated in " << totalSeconds << " s" << std::endl;
+
+    return failed == 0 ? 0 : 1;
+}
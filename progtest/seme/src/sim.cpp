@@ -0,0 +1,98 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "CSimulation.h"
+#include "CEventSimulation.h"
+#include "CAllocationTracker.h"
+
+constexpr int ALLOCATION_CHECK_STEPS = 200000; // steps of the allocation check, about 26 simulated minutes, in which the bot clears a level of the default map
+
+////////////////////////////////////////////////////////////////////////////////
+/// Runs a number of headless games and prints their results. If a directory is given, every game is recorded into it (replay_0.bin, replay_1.bin, ...),
+/// e.g. to start a corpus for svobov25-replay.
+///
+/// Built by make allocdebug (svobov25-sim-allocdebug), it also checks that a running game does not allocate and fails if it does. The check plays
+/// ALLOCATION_CHECK_STEPS steps, with the player put back on its start tile when caught, and fails as well if they do not reach a level change,
+/// a power up expiry and a guard mode switch.
+///
+/// With -e, the games are played by CEventSimulation, which skips over the steps in which nothing is decided. The results are the same,
+/// the number of steps it actually took is printed at the end.
+///
+/// Usage: svobov25-sim [-e] [games] [seed] [config] [replay directory]
+int main(int argc, char *argv[])
+{
+    int argument = 1;
+    bool events = argc > 1 && strcmp(argv[1], "-e") == 0;
+    if (events)
+        argument++;
+
+    int games = argc > argument ? atoi(argv[argument]) : 1;
+    unsigned int seed = argc > argument + 1 ? atoi(argv[argument + 1]) : 0;
+    std::string configPath = argc > argument + 2 ? argv[argument + 2] : "./src/settings.conf";
+    std::string replayDir = argc > argument + 3 ? argv[argument + 3] : "";
+
+    CGameState gamestate;
+    gamestate.loadConfig(configPath);
+    CSimulation::prepare(gamestate);
+
+    long long totalScore = 0;
+    long long takenSteps = 0;
+    long long skippedSteps = 0;
+    for (int i = 0; i < games; i++)
+    {
+        CReplay replay;
+        CReplay *recording = replayDir.empty() ? nullptr : &replay;
+        CGameResult result;
+
+        if (events)
+        {
+            CEventSimulation simulation(gamestate, seed + i, recording);
+            result = simulation.play();
+            takenSteps += simulation.getTakenSteps();
+            skippedSteps += simulation.getSkippedSteps();
+        }
+        else
+            result = CSimulation::play(gamestate, seed + i, recording);
+
+        totalScore += result.score;
+
+        if (!replayDir.empty() && !replay.write(replayDir + "/replay_" + std::to_string(i) + ".bin"))
+            std::cout << "Error writing replay " << i << "." << std::endl;
+
+        std::cout << "game " << i
+                  << " score " << result.score
+                  << " level " << result.level
+                  << " time " << result.time
+                  << (result.over ? " caught" : " time limit") << std::endl;
+    }
+
+    if (games > 0)
+        std::cout << "average score " << totalScore / static_cast<double>(games) << std::endl;
+
+    if (events)
+        std::cout << "steps taken " << takenSteps << " of " << takenSteps + skippedSteps << std::endl;
+
+    // in the allocation debug build, one more game checks that the steps of a running game do not allocate
+    if (CAllocationTracker::isEnabled())
+    {
+        CAllocationCheck check = CSimulation::checkAllocations(gamestate, seed, ALLOCATION_CHECK_STEPS);
+        std::cout << "allocation check: " << check.allocatingSteps << " of " << ALLOCATION_CHECK_STEPS << " steps allocated, "
+                  << check.levelChanges << " level changes, "
+                  << check.powerUpsExpired << " power ups expired, "
+                  << check.guardSwitches << " guard mode switches, "
+                  << check.catches << " catches" << std::endl;
+        if (check.allocatingSteps > 0)
+            return 1;
+
+        // a check that never got to these changes of the game did not see their steps
+        if (check.levelChanges == 0 || check.powerUpsExpired == 0 || check.guardSwitches == 0)
+        {
+            std::cout << "The allocation check did not reach a level change, a power up expiry and a guard mode switch." << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "CGame.h"
+#include "CBot.h"
+#include "CSimulation.h"
+
+constexpr int SWARM_SIZES[] = {3, 10, 30, 100, 300, 1000, 3000, 10000}; // the smallest numbers of ghosts measured, rounded up to a multiple of the start tiles
+
+////////////////////////////////////////////////////////////////////////////////
+/// Measures how the update of the ghosts scales with their number. For every swarm size, the bot plays on the map with SPAWN_COUNT set so that
+/// the start tiles spawn at least that many ghosts, and the time of the ghosts phase (their moves and their collisions with the player) of every step
+/// is summed up. When the player is caught, it is put back on its start tile and the game goes on, so that every swarm size is measured over one
+/// uninterrupted game.
+///
+/// Usage: svobov25-swarm [steps] [config]
+int main(int argc, char *argv[])
+{
+    int steps = argc > 1 ? atoi(argv[1]) : 5000;
+    std::string configPath = argc > 2 ? argv[2] : "./src/settings.conf";
+
+    CGameState gamestate;
+    gamestate.loadConfig(configPath);
+    CSimulation::prepare(gamestate);
+
+    // every start tile spawns the same number of ghosts, a game with one ghost per tile counts them
+    gamestate.SPAWN_COUNT = 1;
+    CGame counter;
+    counter.gamestate = gamestate;
+    counter.setup();
+    int spawners = counter.ghosts.size();
+    if (spawners == 0)
+    {
+        std::cout << "The map has no ghost start tiles." << std::endl;
+        return 1;
+    }
+
+    std::cout << "ghosts,spawn count,steps,update us/step,update ns/ghost" << std::endl;
+
+    for (int size : SWARM_SIZES)
+    {
+        gamestate.SPAWN_COUNT = (size + spawners - 1) / spawners;
+
+        CProfiler profiler;
+        CGame game;
+        game.gamestate = gamestate;
+        game.profiler = &profiler;
+        game.setup();
+        game.gamestate.screen = CGameState::CScreen::playing;
+        CPos start = game.gamestate.playerPos;
+
+        CBot bot(0);
+        double seconds = 0;
+
+        for (int step = 0; step < steps; step++)
+        {
+            bot.update(game.gamestate);
+            profiler.beginFrame();
+            game.step();
+            profiler.endFrame();
+            seconds += profiler.getPhaseTime(profiler.getFrameCount() - 1, CProfiler::ghosts);
+
+            // a large swarm catches the player every few steps. The catch is undone instead of starting a new game, the score is never logged
+            if (game.gamestate.screen == CGameState::CScreen::gameOver)
+            {
+                game.gamestate.screen = CGameState::CScreen::playing;
+                game.gamestate.scorePending = false;
+                game.gamestate.playerPos = start;
+                game.gamestate.previousPlayerPos = start;
+                game.gamestate.thisMove = CDirection::none;
+                game.gamestate.nextMove = CDirection::none;
+            }
+        }
+
+        int ghosts = game.ghosts.size();
+        std::cout << ghosts << ","
+                  << gamestate.SPAWN_COUNT << ","
+                  << steps << ","
+                  << seconds / steps * 1e6 << ","
+                  << seconds / steps / ghosts * 1e9 << std::endl;
+    }
+
+    return 0;
+}
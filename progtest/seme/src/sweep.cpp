@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CSimulation.h"
+#include "CWorkStealingPool.h"
+
+/** \class CParameter
+A gameplay constant and the values it takes in the sweep.
+*/
+struct CParameter
+{
+    std::string name;                ///< name of the constant, as written in the config file
+    std::vector<std::string> values; ///< the values, as written in the config file
+};
+
+/** \class CConfiguration
+A single point of the sweep: a map and one value of every parameter.
+*/
+struct CConfiguration
+{
+    size_t map;                      ///< index of the map
+    std::vector<std::string> values; ///< value of every parameter, in the order of the grid
+    CGameState gamestate;            ///< the map's config with the values applied, every game of the configuration starts from it
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Loads the parameter grid. Every line is "NAME: value value ...", everything after a # is ignored.
+///
+/// @param [in] path path to the grid file
+/// @throws std::invalid_argument if the file cannot be read
+std::vector<CParameter> loadGrid(const std::string &path)
+{
+    std::ifstream grid(path);
+    if (!grid.is_open())
+        throw std::invalid_argument("unable to open parameter grid " + path);
+
+    std::vector<CParameter> parameters;
+    std::string line;
+    while (getline(grid, line))
+    {
+        line = line.substr(0, line.find('#'));
+        size_t colon = line.find(':');
+        if (colon == std::string::npos)
+        {
+            if (line.find_first_not_of(" \t\r") != std::string::npos)
+                throw std::invalid_argument("unable to read parameter grid line \"" + line + "\"");
+            continue;
+        }
+
+        CParameter parameter;
+        std::istringstream names(line.substr(0, colon));
+        std::istringstream values(line.substr(colon + 1));
+        names >> parameter.name;
+
+        std::string value;
+        while (values >> value)
+            parameter.values.push_back(value);
+
+        if (parameter.values.empty())
+            throw std::invalid_argument("parameter " + parameter.name + " has no values");
+
+        parameters.push_back(parameter);
+    }
+
+    return parameters;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Builds every combination of the parameter values on every map.
+///
+/// @param [in] parameters the parameter grid
+/// @param [in] maps the gamestates loaded from the map config files
+/// @throws std::invalid_argument if a parameter is unknown or one of its values cannot be read
+std::vector<CConfiguration> buildConfigurations(const std::vector<CParameter> &parameters, const std::vector<CGameState> &maps)
+{
+    std::vector<CConfiguration> configurations;
+
+    for (size_t map = 0; map < maps.size(); map++)
+    {
+        // the combinations are counted like a number whose digits are the value indices, the last parameter changes fastest
+        std::vector<size_t> digits(parameters.size(), 0);
+        while (true)
+        {
+            CConfiguration configuration;
+            configuration.map = map;
+            configuration.gamestate = maps[map];
+            for (size_t i = 0; i < parameters.size(); i++)
+            {
+                configuration.values.push_back(parameters[i].values[digits[i]]);
+                configuration.gamestate.setParameter(parameters[i].name, parameters[i].values[digits[i]]);
+            }
+            configurations.push_back(configuration);
+
+            size_t i = parameters.size();
+            while (i > 0 && ++digits[i - 1] == parameters[i - 1].values.size())
+                digits[--i] = 0;
+
+            if (i == 0)
+                break;
+        }
+    }
+
+    return configurations;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes the distribution of a sample as CSV columns: mean, standard deviation, minimum, 10th, 50th and 90th percentile and maximum.
+///
+/// @param [in] output the stream written to
+/// @param [in] sample the sample, it gets sorted
+void writeDistribution(std::ostream &output, std::vector<double> &sample)
+{
+    std::sort(sample.begin(), sample.end());
+
+    double mean = 0;
+    for (double value : sample)
+        mean += value;
+    mean /= sample.size();
+
+    double variance = 0;
+    for (double value : sample)
+        variance += (value - mean) * (value - mean);
+    variance /= sample.size();
+
+    auto percentile = [&sample](double p)
+    { return sample[static_cast<size_t>(std::round(p * (sample.size() - 1)))]; };
+
+    output << ',' << mean << ',' << std::sqrt(variance)
+           << ',' << sample.front() << ',' << percentile(0.1) << ',' << percentile(0.5) << ',' << percentile(0.9) << ',' << sample.back();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes one CSV line per configuration with the distributions of score, level and survival time of its games.
+///
+/// @param [in] path path to the output file
+/// @param [in] parameters the parameter grid
+/// @param [in] mapPaths paths to the map config files
+/// @param [in] configurations the configurations
+/// @param [in] results results of all games, the games of a configuration are stored next to each other
+/// @param [in] games number of games per configuration
+/// @return false if the file cannot be written
+bool writeResults(const std::string &path, const std::vector<CParameter> &parameters, const std::vector<std::string> &mapPaths,
+                  const std::vector<CConfiguration> &configurations, const std::vector<CGameResult> &results, int games)
+{
+    std::ofstream output(path);
+    if (!output.is_open())
+        return false;
+
+    output << "map";
+    for (const CParameter &parameter : parameters)
+        output << ',' << parameter.name;
+    output << ",games,caught";
+    for (const char *column : {"score", "level", "time"})
+        for (const char *statistic : {"mean", "sd", "min", "p10", "p50", "p90", "max"})
+            output << ',' << column << '_' << statistic;
+    output << '\n';
+
+    std::vector<double> scores(games), levels(games), times(games);
+    for (size_t i = 0; i < configurations.size(); i++)
+    {
+        int caught = 0;
+        for (int game = 0; game < games; game++)
+        {
+            const CGameResult &result = results[i * games + game];
+            scores[game] = result.score;
+            levels[game] = result.level;
+            times[game] = result.time;
+            caught += result.over;
+        }
+
+        output << mapPaths[configurations[i].map];
+        for (const std::string &value : configurations[i].values)
+            output << ',' << value;
+        output << ',' << games << ',' << caught;
+        writeDistribution(output, scores);
+        writeDistribution(output, levels);
+        writeDistribution(output, times);
+        output << '\n';
+    }
+
+    return static_cast<bool>(output);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Runs a parameter sweep: many headless games for every combination of the parameter values on every map, spread over all cores.
+///
+/// Usage: svobov25-sweep [-j threads] grid games output [map config ...]
+///
+/// The games of every configuration use the seeds 0 ... games - 1, so that configurations are compared on the same bot behavior.
+int main(int argc, char *argv[])
+{
+    unsigned int threads = 0;
+    int argument = 1;
+    if (argc > 2 && strcmp(argv[1], "-j") == 0)
+    {
+        threads = atoi(argv[2]);
+        argument = 3;
+    }
+
+    if (argc - argument < 3)
+    {
+        std::cout << "Usage: svobov25-sweep [-j threads] grid games output [map config ...]" << std::endl;
+        return 1;
+    }
+
+    std::string gridPath = argv[argument];
+    int games = atoi(argv[argument + 1]);
+    std::string outputPath = argv[argument + 2];
+    std::vector<std::string> mapPaths(argv + argument + 3, argv + argc);
+    if (mapPaths.empty())
+        mapPaths.push_back("./src/settings.conf");
+
+    if (games <= 0)
+    {
+        std::cout << "The number of games has to be positive." << std::endl;
+        return 1;
+    }
+
+    std::vector<CGameState> maps(mapPaths.size());
+    for (size_t map = 0; map < maps.size(); map++)
+    {
+        maps[map].loadConfig(mapPaths[map]);
+        CSimulation::prepare(maps[map]);
+    }
+
+    std::vector<CParameter> parameters;
+    std::vector<CConfiguration> configurations;
+    try
+    {
+        parameters = loadGrid(gridPath);
+        configurations = buildConfigurations(parameters, maps);
+    }
+    catch (std::invalid_argument &e)
+    {
+        std::cout << e.what() << " Please check the parameter grid." << std::endl;
+        return 1;
+    }
+
+    CWorkStealingPool pool(threads);
+    std::vector<CGameResult> results(configurations.size() * games);
+    std::cout << configurations.size() << " configurations, " << results.size() << " games, " << pool.getThreadCount() << " threads" << std::endl;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    pool.run(results.size(), [&](size_t task)
+             { results[task] = CSimulation::play(configurations[task / games].gamestate, task % games); });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "finished in " << elapsed.count() << " s" << std::endl;
+
+    if (!writeResults(outputPath, parameters, mapPaths, configurations, results, games))
+    {
+        std::cout << "Unable to write " << outputPath << std::endl;
+        return 1;
+    }
+
+    return 0;
+}